@@ -0,0 +1,8 @@
+
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+    mat4 lightSpaceMatrix;
+    vec3 lightPos;
+};
@@ -0,0 +1,9 @@
+
+#version 330 core
+
+// one triangle covering the whole target, the corners come from the vertex index so no buffers are needed
+
+void main() {
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,26 @@
+
+#version 330 core
+
+// colors the pixels within width of a masked pixel but outside the mask with the color of that pixel,
+// the last half pixel fades out to keep the edge smooth
+
+const uint NONE = 65535u;
+
+out vec4 FragColor;
+
+uniform sampler2D mask;
+uniform usampler2D seeds;
+uniform float width;
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    uvec2 seed = texelFetch(seeds, pixel, 0).xy;
+    if(seed.x == NONE || texelFetch(mask, pixel, 0).a > 0.5)
+        discard;
+
+    float distance = length(vec2(seed) - vec2(pixel));
+    if(distance > width + 0.5)
+        discard;
+
+    FragColor = vec4(texelFetch(mask, ivec2(seed), 0).rgb, clamp(width + 0.5 - distance, 0.0, 1.0));
+}
@@ -0,0 +1,40 @@
+
+#version 330 core
+
+// one jump flood step, keeps the nearest of the seeds found step pixels away in the eight directions and here
+
+const uint NONE = 65535u;
+
+out uvec2 Seed;
+
+uniform usampler2D seeds;
+uniform int step;
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 size = textureSize(seeds, 0);
+
+    uvec2 nearest = uvec2(NONE);
+    float nearestDistance = 1e20;
+
+    for(int y = -1; y <= 1; y++) {
+        for(int x = -1; x <= 1; x++) {
+            ivec2 neighbour = pixel + ivec2(x, y) * step;
+            if(any(lessThan(neighbour, ivec2(0))) || any(greaterThanEqual(neighbour, size)))
+                continue;
+
+            uvec2 seed = texelFetch(seeds, neighbour, 0).xy;
+            if(seed.x == NONE)
+                continue;
+
+            vec2 offset = vec2(seed) - vec2(pixel);
+            float distance = dot(offset, offset);
+            if(distance < nearestDistance) {
+                nearestDistance = distance;
+                nearest = seed;
+            }
+        }
+    }
+
+    Seed = nearest;
+}
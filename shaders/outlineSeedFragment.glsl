@@ -0,0 +1,15 @@
+
+#version 330 core
+
+// every covered pixel of the mask is its own nearest seed, the rest have none yet
+
+const uint NONE = 65535u;
+
+out uvec2 Seed;
+
+uniform sampler2D mask;
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    Seed = texelFetch(mask, pixel, 0).a > 0.5 ? uvec2(pixel) : uvec2(NONE);
+}
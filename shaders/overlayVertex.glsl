@@ -0,0 +1,17 @@
+
+#version 330 core
+
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoords;
+layout (location = 2) in vec4 aColor;
+
+out vec2 TexCoords;
+out vec4 Color;
+
+uniform vec2 screenSize;
+
+void main() {
+    TexCoords = aTexCoords;
+    Color = aColor;
+    gl_Position = vec4(aPos / screenSize * vec2(2.0, -2.0) + vec2(-1.0, 1.0), 0.0, 1.0);
+}
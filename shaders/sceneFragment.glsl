@@ -0,0 +1,123 @@
+
+#version 330 core
+
+// DEPTH_ONLY writes nothing but depth, LIT shades with SHADOW_TAPS (1, 4 or 16) hardware compared shadow taps,
+// anything else fills with the color uniform
+
+#include "frame.glsl"
+
+#if defined(DEPTH_ONLY)
+
+void main() {}
+
+#elif defined(LIT)
+
+#ifndef SHADOW_TAPS
+#define SHADOW_TAPS 4
+#endif
+
+out vec4 FragColor;
+
+in VS_OUT {
+    vec3 FragPos;
+    vec3 Normal;
+    vec4 FragPosLightSpace;
+    flat vec3 Color;
+} fs_in;
+
+uniform sampler2DShadow shadowMap;
+
+// radius of the filter in texels, each tap is itself a bilinear 2x2 comparison
+const float FILTER_RADIUS = 1.5;
+
+#if SHADOW_TAPS == 4
+const vec2 POISSON[4] = vec2[](
+    vec2(-0.94201624, -0.39906216),
+    vec2(0.94558609, -0.76890725),
+    vec2(-0.09418410, -0.92938870),
+    vec2(0.34495938, 0.29387760)
+);
+#elif SHADOW_TAPS == 16
+const vec2 POISSON[16] = vec2[](
+    vec2(-0.94201624, -0.39906216),
+    vec2(0.94558609, -0.76890725),
+    vec2(-0.09418410, -0.92938870),
+    vec2(0.34495938, 0.29387760),
+    vec2(-0.91588581, 0.45771432),
+    vec2(-0.81544232, -0.87912464),
+    vec2(-0.38277543, 0.27676845),
+    vec2(0.97484398, 0.75648379),
+    vec2(0.44323325, -0.97511554),
+    vec2(0.53742981, -0.47373420),
+    vec2(-0.26496911, -0.41893023),
+    vec2(0.79197514, 0.19090188),
+    vec2(-0.24188840, 0.99706507),
+    vec2(-0.81409955, 0.91437590),
+    vec2(0.19984126, 0.78641367),
+    vec2(0.14383161, -0.14100790)
+);
+#endif
+
+float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+    projCoords = projCoords * 0.5 + 0.5;
+
+    if(projCoords.z > 1.0)
+        return 0.0;
+
+    float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.005);
+    vec3 reference = vec3(projCoords.xy, projCoords.z - bias);
+
+#if SHADOW_TAPS == 1
+    return 1.0 - texture(shadowMap, reference);
+#else
+    vec2 radius = FILTER_RADIUS / vec2(textureSize(shadowMap, 0));
+
+#if SHADOW_TAPS == 16
+    // the pattern is turned per pixel, so the few taps show up as fine noise rather than as repeated banding
+    float angle = 6.2831853 * fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+#else
+    mat2 rotation = mat2(1.0);
+#endif
+
+    float lit = 0.0;
+    for(int i = 0; i < SHADOW_TAPS; i++)
+        lit += texture(shadowMap, vec3(reference.xy + rotation * POISSON[i] * radius, reference.z));
+
+    return 1.0 - lit / float(SHADOW_TAPS);
+#endif
+}
+
+void main() {
+    vec3 normal = normalize(fs_in.Normal);
+    vec3 lightColor = vec3(0.3);
+
+    vec3 ambient = 0.3 * lightColor;
+
+    vec3 lightDir = normalize(lightPos - fs_in.FragPos);
+    float diff = max(dot(lightDir, normal), 0.0);
+    vec3 diffuse = diff * lightColor;
+
+    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), 64.0);
+    vec3 specular = spec * lightColor;
+
+    float shadow = ShadowCalculation(fs_in.FragPosLightSpace, normal, lightDir);
+    vec3 lighting = (ambient + (1.0 - shadow) * (diffuse + specular)) * fs_in.Color * 2;
+
+    FragColor = vec4(lighting, 1.0);
+}
+
+#else
+
+out vec4 FragColor;
+
+uniform vec3 color;
+
+void main() {
+    FragColor = vec4(color, 1.0);
+}
+
+#endif
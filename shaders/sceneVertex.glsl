@@ -0,0 +1,49 @@
+
+#version 330 core
+
+// INSTANCED takes the model matrix per instance, otherwise from the model uniform
+// LIT passes what the lighting needs, the normal matrix comes per instance from the CPU
+// DEPTH_ONLY projects into the light's space for the shadow map
+
+#include "frame.glsl"
+
+layout (location = 0) in vec3 aPos;
+
+#ifdef INSTANCED
+layout (location = 2) in mat4 aModel;
+#else
+uniform mat4 model;
+#endif
+
+#ifdef LIT
+layout (location = 1) in vec3 aNormal;
+layout (location = 6) in vec3 aColor;
+layout (location = 7) in mat3 aNormalMatrix;
+
+out VS_OUT {
+    vec3 FragPos;
+    vec3 Normal;
+    vec4 FragPosLightSpace;
+    flat vec3 Color;
+} vs_out;
+#endif
+
+void main() {
+#ifdef INSTANCED
+    vec4 worldPos = aModel * vec4(aPos, 1.0);
+#else
+    vec4 worldPos = model * vec4(aPos, 1.0);
+#endif
+
+#ifdef DEPTH_ONLY
+    gl_Position = lightSpaceMatrix * worldPos;
+#else
+#ifdef LIT
+    vs_out.FragPos = worldPos.xyz;
+    vs_out.Normal = aNormalMatrix * aNormal;
+    vs_out.FragPosLightSpace = lightSpaceMatrix * worldPos;
+    vs_out.Color = aColor;
+#endif
+    gl_Position = projection * view * worldPos;
+#endif
+}
@@ -0,0 +1,90 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AssetLoader.hpp"
+#include <SDL2/SDL.h>
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+AssetLoader::AssetLoader(int threads) :
+    mPool(new ThreadPool(threads)),
+    mStart(std::chrono::steady_clock::now()),
+    mTimingsMutex(),
+    mTimings()
+{}
+
+AssetLoader::~AssetLoader() {
+    delete mPool;
+}
+
+PendingAsset<std::string> AssetLoader::loadShaderSource(const std::string& path) {
+    return PendingAsset<std::string>{path, mPool->submit([this, path]() {
+        const auto start = std::chrono::steady_clock::now();
+        std::string source = CompoundShader::readSource(path);
+        recordLoad(path, millisecondsSince(start));
+        return source;
+    })};
+}
+
+PendingAsset<ModelData> AssetLoader::loadModel(const std::string& path) {
+    return PendingAsset<ModelData>{path, mPool->submit([this, path]() {
+        const auto start = std::chrono::steady_clock::now();
+        ModelData data = Model::load(path);
+        recordLoad(path, millisecondsSince(start));
+        return data;
+    })};
+}
+
+// the variants are compiled by the library when they're first asked for, so there's nothing to upload here
+void AssetLoader::takeShaderSource(PendingAsset<std::string>& pending, ShaderLibrary* library) {
+    library->addSource(pending.name, pending.future.get());
+}
+
+Model* AssetLoader::takeModel(PendingAsset<ModelData>& pending, MeshArena* arena) {
+    ModelData data = pending.future.get();
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto model = new Model(std::move(data), arena);
+    recordUpload(pending.name, millisecondsSince(start));
+
+    return model;
+}
+
+// load times are spent on the workers, upload times on the GL thread
+void AssetLoader::report() {
+    std::lock_guard lock(mTimingsMutex);
+
+    for (const auto& timing : mTimings)
+        SDL_Log("%-36s load %8.2f ms, upload %8.2f ms", timing.name.c_str(), timing.loadMilliseconds, timing.uploadMilliseconds);
+    SDL_Log("assets ready after %.2f ms on %d threads", millisecondsSince(mStart), mPool->size());
+}
+
+void AssetLoader::recordLoad(const std::string& name, double milliseconds) {
+    std::lock_guard lock(mTimingsMutex);
+    mTimings.push_back(Timing{name, milliseconds, 0.0});
+}
+
+void AssetLoader::recordUpload(const std::string& name, double milliseconds) {
+    std::lock_guard lock(mTimingsMutex);
+    for (auto& timing : mTimings) {
+        if (timing.name == name)
+            timing.uploadMilliseconds = milliseconds;
+    }
+}
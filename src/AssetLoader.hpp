@@ -0,0 +1,69 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "CompoundShader.hpp"
+#include "Model.hpp"
+#include "ShaderLibrary.hpp"
+#include "ThreadPool.hpp"
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// an asset still being loaded, the name is what its timings are reported under
+template <typename T>
+struct PendingAsset {
+    std::string name;
+    std::future<T> future;
+};
+
+// reads, parses and preprocesses assets on a thread pool while the window and the context come up,
+// the GL thread then only uploads them, waiting on each one as it's taken which makes the takes a barrier
+class AssetLoader final {
+private:
+    struct Timing {
+        std::string name;
+        double loadMilliseconds, uploadMilliseconds;
+    };
+
+    ThreadPool* mPool;
+    std::chrono::steady_clock::time_point mStart;
+    std::mutex mTimingsMutex;
+    std::vector<Timing> mTimings;
+public:
+    explicit AssetLoader(int threads);
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader(AssetLoader&&) = delete;
+
+    ~AssetLoader();
+
+    AssetLoader& operator =(const AssetLoader&) = delete;
+    AssetLoader& operator =(AssetLoader&&) = delete;
+
+    PendingAsset<std::string> loadShaderSource(const std::string& path);
+    PendingAsset<ModelData> loadModel(const std::string& path);
+    void takeShaderSource(PendingAsset<std::string>& pending, ShaderLibrary* library);
+    Model* takeModel(PendingAsset<ModelData>& pending, MeshArena* arena);
+    void report();
+private:
+    void recordLoad(const std::string& name, double milliseconds);
+    void recordUpload(const std::string& name, double milliseconds);
+};
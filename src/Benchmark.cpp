@@ -0,0 +1,105 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmark.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <SDL2/SDL.h>
+
+static void appendf(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void appendf(std::string& out, const char* format, ...) {
+    char buffer[256];
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(buffer, sizeof buffer, format, arguments);
+    va_end(arguments);
+    out += buffer;
+}
+
+// nearest-rank percentiles over a sorted copy of the samples, all in milliseconds
+static void appendStatistics(std::string& out, std::vector<float> samples) {
+    std::sort(samples.begin(), samples.end());
+
+    double total = 0.0;
+    for (const float sample : samples)
+        total += sample;
+
+    const auto percentile = [&samples](float rank) {
+        if (samples.empty()) return 0.0f;
+        const auto index = static_cast<size_t>(rank / 100.0f * static_cast<float>(samples.size() - 1) + 0.5f);
+        return samples[index];
+    };
+
+    appendf(
+        out,
+        "{\"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+        samples.empty() ? 0.0 : total / static_cast<double>(samples.size()),
+        percentile(50.0f),
+        percentile(90.0f),
+        percentile(99.0f),
+        samples.empty() ? 0.0f : samples.back()
+    );
+}
+
+Benchmark::Benchmark(int frames) : mFrameTimes(), mCpuTimes(), mGpuTimes() {
+    mFrameTimes.reserve(frames);
+    for (int pass = 0; pass < Profiler::PASS_COUNT; pass++) {
+        mCpuTimes[pass].reserve(frames);
+        mGpuTimes[pass].reserve(frames);
+    }
+}
+
+void Benchmark::record(float frameTime, Profiler* profiler) {
+    mFrameTimes.push_back(frameTime);
+    for (int pass = 0; pass < Profiler::PASS_COUNT; pass++) {
+        mCpuTimes[pass].push_back(profiler->cpuTime(static_cast<Profiler::Pass>(pass)));
+        mGpuTimes[pass].push_back(profiler->gpuTime(static_cast<Profiler::Pass>(pass)));
+    }
+}
+
+bool Benchmark::write(const std::string& path, const std::string& renderer, int width, int height) {
+    std::string json;
+    appendf(json, "{\n  \"frames\": %zu,\n  \"width\": %d,\n  \"height\": %d,\n", mFrameTimes.size(), width, height);
+
+    json += "  \"renderer\": \"";
+    for (const char c : renderer) {
+        if (c == '"' || c == '\\') json += '\\';
+        json += c;
+    }
+    json += "\",\n  \"frameTime\": ";
+    appendStatistics(json, mFrameTimes);
+    json += ",\n  \"passes\": {\n";
+
+    for (int pass = 0; pass < Profiler::PASS_COUNT; pass++) {
+        appendf(json, "    \"%s\": {\"cpu\": ", Profiler::passName(static_cast<Profiler::Pass>(pass)));
+        appendStatistics(json, mCpuTimes[pass]);
+        json += ", \"gpu\": ";
+        appendStatistics(json, mGpuTimes[pass]);
+        json += pass < Profiler::PASS_COUNT - 1 ? "},\n" : "}\n";
+    }
+    json += "  }\n}\n";
+
+    SDL_RWops* file = SDL_RWFromFile(path.c_str(), "w");
+    if (file == nullptr) return false;
+
+    const bool written = SDL_RWwrite(file, json.data(), 1, json.size()) == json.size();
+    SDL_RWclose(file);
+    return written;
+}
@@ -0,0 +1,39 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Profiler.hpp"
+#include <string>
+#include <vector>
+
+class Benchmark final {
+private:
+    std::vector<float> mFrameTimes;
+    std::vector<float> mCpuTimes[Profiler::PASS_COUNT], mGpuTimes[Profiler::PASS_COUNT];
+public:
+    explicit Benchmark(int frames);
+    Benchmark(const Benchmark&) = delete;
+    Benchmark(Benchmark&&) = delete;
+
+    Benchmark& operator =(const Benchmark&) = delete;
+    Benchmark& operator =(Benchmark&&) = delete;
+
+    void record(float frameTime, Profiler* profiler);
+    bool write(const std::string& path, const std::string& renderer, int width, int height);
+};
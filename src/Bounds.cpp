@@ -0,0 +1,66 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Bounds.hpp"
+#include <algorithm>
+#include <cmath>
+
+// the merged sphere stays centered on the merged box and grows until it holds both spheres
+void Bounds::merge(const Bounds& other) {
+    if (other.min.x > other.max.x) return;
+
+    const bool wasEmpty = min.x > max.x;
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+
+    const glm::vec3 oldCenter = center;
+    center = (min + max) * 0.5f;
+    radius = std::max(
+        wasEmpty ? 0.0f : glm::length(oldCenter - center) + radius,
+        glm::length(other.center - center) + other.radius
+    );
+}
+
+// the box is refitted around the transformed one and the sphere is scaled by the largest axis scale
+Bounds Bounds::transformed(const glm::mat4& matrix) const {
+    if (min.x > max.x) return *this;
+
+    Bounds result;
+    result.min = result.max = glm::vec3(matrix[3]);
+
+    for (int column = 0; column < 3; column++) {
+        const glm::vec3 axis(matrix[column]);
+        const glm::vec3 a = axis * min[column], b = axis * max[column];
+        result.min += glm::min(a, b);
+        result.max += glm::max(a, b);
+    }
+
+    const float scale = std::sqrt(std::max(
+        std::max(glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])), glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1]))),
+        glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]))
+    ));
+
+    result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+    result.radius = radius * scale;
+    return result;
+}
+
+// merging anything into it yields the other bounds
+Bounds Bounds::empty() {
+    return Bounds{glm::vec3(INFINITY), glm::vec3(-INFINITY), glm::vec3(0.0f), 0.0f};
+}
@@ -0,0 +1,33 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+// an axis aligned box together with a sphere around it, the sphere is the cheap test and the box the tight one
+struct Bounds {
+    glm::vec3 min, max;
+    glm::vec3 center;
+    float radius;
+
+    void merge(const Bounds& other);
+    Bounds transformed(const glm::mat4& matrix) const;
+
+    static Bounds empty();
+};
@@ -19,6 +19,7 @@
 #include "Camera.hpp"
 #include <cmath>
 #include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
 
 Camera::Camera(const glm::vec3& position, const glm::vec3& up, float yaw, float pitch) :
     mPosition(position),
@@ -27,13 +28,33 @@ Camera::Camera(const glm::vec3& position, const glm::vec3& up, float yaw, float
     mRight(),
     mWorldUp(up),
     mYaw(yaw),
-    mPitch(pitch)
+    mPitch(pitch),
+    mView(1.0f),
+    mProjection(1.0f)
 {
     updateCameraVectors();
 }
 
 glm::mat4 Camera::viewMatrix() {
-    return glm::lookAt(mPosition, mPosition + mFront, mUp);
+    if (mViewDirty) {
+        mView = glm::lookAt(mPosition, mPosition + mFront, mUp);
+        mViewDirty = false;
+    }
+    return mView;
+}
+
+glm::mat4 Camera::projectionMatrix() {
+    if (mProjectionDirty) {
+        mProjection = glm::perspective(glm::radians(mZoom), mAspect, 0.1f, 100.0f);
+        mProjectionDirty = false;
+    }
+    return mProjection;
+}
+
+void Camera::setAspect(float aspect) {
+    if (aspect == mAspect) return;
+    mAspect = aspect;
+    invalidateProjection();
 }
 
 void Camera::processKeyboard(Direction direction) {
@@ -57,9 +78,12 @@ void Camera::processKeyboard(Direction direction) {
             mPosition -= mUp * mSpeed;
             break;
     }
+    invalidateView();
 }
 
 void Camera::processMouseMovement(float xOffset, float yOffset) {
+    if (xOffset == 0.0f && yOffset == 0.0f) return;
+
     xOffset *= mSensitivity;
     yOffset *= mSensitivity;
 
@@ -75,11 +99,16 @@ void Camera::processMouseMovement(float xOffset, float yOffset) {
 }
 
 void Camera::processMouseScroll(float yOffset) {
+    const float zoom = mZoom;
+
     mZoom -= yOffset;
     if (mZoom < 1.0f)
         mZoom = 1.0f;
     if (mZoom > 45.0f)
         mZoom = 45.0f;
+
+    if (mZoom != zoom)
+        invalidateProjection();
 }
 
 void Camera::updateCameraVectors() {
@@ -91,6 +120,18 @@ void Camera::updateCameraVectors() {
 
     mRight = glm::normalize(glm::cross(mFront, mWorldUp));
     mUp = glm::normalize(glm::cross(mRight, mFront));
+
+    invalidateView();
+}
+
+void Camera::invalidateView() {
+    mViewDirty = true;
+    mRevision++;
+}
+
+void Camera::invalidateProjection() {
+    mProjectionDirty = true;
+    mRevision++;
 }
 
 float Camera::zoom() {
@@ -112,3 +153,7 @@ float Camera::yaw() {
 float Camera::pitch() {
     return mPitch;
 }
+
+unsigned Camera::revision() {
+    return mRevision;
+}
@@ -35,6 +35,10 @@ private:
     float mYaw = -90.0f, mPitch = 0.0f;
     const float mSpeed = 0.1f, mSensitivity = 0.1f;
     float mZoom = 45.0f;
+    float mAspect = 1.0f;
+    glm::mat4 mView, mProjection;
+    bool mViewDirty = true, mProjectionDirty = true;
+    unsigned mRevision = 0;
 public:
     explicit Camera(
         const glm::vec3& position = glm::vec3(0.0f, 0.0f, 0.0f),
@@ -49,6 +53,8 @@ public:
     Camera& operator =(Camera&&) = delete;
 
     glm::mat4 viewMatrix();
+    glm::mat4 projectionMatrix();
+    void setAspect(float aspect);
     void processKeyboard(Direction direction);
     void processMouseMovement(float xOffset, float yOffset);
     void processMouseScroll(float yOffset);
@@ -57,6 +63,9 @@ public:
     glm::vec3 front();
     float yaw();
     float pitch();
+    unsigned revision();
 private:
     void updateCameraVectors();
+    void invalidateView();
+    void invalidateProjection();
 };
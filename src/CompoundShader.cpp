@@ -17,26 +17,40 @@
  */
 
 #include "CompoundShader.hpp"
+#include "GlState.hpp"
+#include "ProgramCache.hpp"
+#include "Stats.hpp"
 #include <SDL2/SDL.h>
+#include <algorithm>
 #include <GL/glew.h>
 #include <glm/gtc/type_ptr.hpp>
 
-CompoundShader::CompoundShader(const std::string& vertexPath, const std::string& fragmentPath) {
-    SDL_RWops* vertexFile = SDL_RWFromFile(vertexPath.c_str(), "r");
-    assert(vertexFile != nullptr);
-    const int vertexSize = (int) SDL_RWsize(vertexFile);
-    char vertexSource[vertexSize + 1];
-    assert(SDL_RWread(vertexFile, vertexSource, 1, vertexSize) == (unsigned long) vertexSize);
-    SDL_RWclose(vertexFile);
-    vertexSource[vertexSize] = 0;
-
-    SDL_RWops* fragmentFile = SDL_RWFromFile(fragmentPath.c_str(), "r");
-    assert(fragmentFile != nullptr);
-    const int fragmentSize = (int) SDL_RWsize(fragmentFile);
-    char fragmentSource[fragmentSize + 1];
-    assert(SDL_RWread(fragmentFile, fragmentSource, 1, fragmentSize) == (unsigned long) fragmentSize);
-    SDL_RWclose(fragmentFile);
-    fragmentSource[fragmentSize] = 0;
+static std::string readFile(const std::string& path) {
+    SDL_RWops* file = SDL_RWFromFile(path.c_str(), "r");
+    assert(file != nullptr);
+    const int size = (int) SDL_RWsize(file);
+    std::string contents(size, '\0');
+    assert(SDL_RWread(file, contents.data(), 1, size) == (unsigned long) size);
+    SDL_RWclose(file);
+    return contents;
+}
+
+CompoundShader::CompoundShader(const std::string& vertexPath, const std::string& fragmentPath) :
+    CompoundShader(readSources(vertexPath, fragmentPath))
+{}
+
+// only compiles and links, so it needs the GL thread, a cached binary of the same sources skips both
+CompoundShader::CompoundShader(const ShaderSources& sources) :
+    mProgramId(ProgramCache::load(sources)),
+    mUniforms(),
+    mMissedWrites(0)
+{
+    if (mProgramId != 0) {
+        reflectUniforms();
+        return;
+    }
+
+    const char* vertexSource = sources.vertex.c_str(), * fragmentSource = sources.fragment.c_str();
 
     int success;
     unsigned vertex = glCreateShader(GL_VERTEX_SHADER);
@@ -54,50 +68,174 @@ CompoundShader::CompoundShader(const std::string& vertexPath, const std::string&
     mProgramId = glCreateProgram();
     glAttachShader(mProgramId, vertex);
     glAttachShader(mProgramId, fragment);
+    if (ProgramCache::supported())
+        glProgramParameteri(mProgramId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(mProgramId);
     glGetProgramiv(mProgramId, GL_LINK_STATUS, &success);
     assert(success == GL_TRUE);
 
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    ProgramCache::store(sources, mProgramId);
+
+    reflectUniforms();
 }
 
 CompoundShader::~CompoundShader() {
-    glDeleteProgram(mProgramId);
+    gGlState.deleteProgram(mProgramId);
+}
+
+// touches no GL state, so it can run on a loader thread
+ShaderSources CompoundShader::readSources(const std::string& vertexPath, const std::string& fragmentPath) {
+    return ShaderSources{readSource(vertexPath), readSource(fragmentPath)};
+}
+
+// reads the file with every #include "name" line replaced by the named file's text, resolved against the including file's directory
+std::string CompoundShader::readSource(const std::string& path) {
+    const std::string contents = readFile(path), directory = path.substr(0, path.find_last_of('/') + 1);
+    std::string expanded;
+    expanded.reserve(contents.size());
+
+    size_t lineStart = 0;
+    while (lineStart < contents.size()) {
+        size_t lineEnd = contents.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = contents.size();
+
+        const std::string_view line(contents.data() + lineStart, lineEnd - lineStart);
+        const size_t directive = line.find_first_not_of(" \t");
+
+        if (directive != std::string_view::npos && line.substr(directive).starts_with("#include")) {
+            const size_t open = line.find('"'), close = line.rfind('"');
+            assert(open != std::string_view::npos && close > open);
+            expanded += readSource(directory + std::string(line.substr(open + 1, close - open - 1)));
+        } else
+            expanded += line;
+
+        expanded += '\n';
+        lineStart = lineEnd + 1;
+    }
+
+    return expanded;
+}
+
+// each define is either "NAME" or "NAME VALUE", they go right after the #version line which has to come first
+std::string CompoundShader::withDefines(const std::string& source, const std::vector<std::string>& defines) {
+    const size_t version = source.find("#version");
+    assert(version != std::string::npos);
+    const size_t insertion = source.find('\n', version) + 1;
+
+    std::string block;
+    for (const auto& define : defines)
+        block += "#define " + define + "\n";
+
+    return source.substr(0, insertion) + block + source.substr(insertion);
 }
 
 void CompoundShader::use() {
-    glUseProgram(mProgramId);
+    gGlState.useProgram(mProgramId);
+}
+
+unsigned CompoundShader::program() {
+    return mProgramId;
+}
+
+void CompoundShader::bindUniformBlock(const char* name, unsigned binding) {
+    const unsigned index = glGetUniformBlockIndex(mProgramId, name);
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(mProgramId, index, binding);
+}
+
+void CompoundShader::setValue(Uniform<bool> uniform, bool value) {
+    if (present(uniform.location))
+        glUniform1i(uniform.location, (int) value);
+}
+
+void CompoundShader::setValue(Uniform<float> uniform, float value) {
+    if (present(uniform.location))
+        glUniform1f(uniform.location, value);
+}
+
+void CompoundShader::setValue(Uniform<int> uniform, int value) {
+    if (present(uniform.location))
+        glUniform1i(uniform.location, value);
+}
+
+void CompoundShader::setValue(Uniform<glm::vec2> uniform, const glm::vec2& value) {
+    if (present(uniform.location))
+        glUniform2f(uniform.location, value.x, value.y);
+}
+
+void CompoundShader::setValue(Uniform<glm::vec3> uniform, const glm::vec3& value) {
+    if (present(uniform.location))
+        glUniform3f(uniform.location, value.x, value.y, value.z);
 }
 
-void CompoundShader::setValue(const std::string& name, bool value) {
-    glUniform1i(glGetUniformLocation(mProgramId, name.c_str()), (int) value);
+void CompoundShader::setValue(Uniform<glm::vec4> uniform, const glm::vec4& value) {
+    if (present(uniform.location))
+        glUniform4f(uniform.location, value.x, value.y, value.z, value.w);
 }
 
-void CompoundShader::setValue(const std::string& name, float value) {
-    glUniform1f(glGetUniformLocation(mProgramId, name.c_str()), value);
+void CompoundShader::setValue(Uniform<glm::mat3> uniform, const glm::mat3& value) {
+    if (present(uniform.location))
+        glUniformMatrix3fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
-void CompoundShader::setValue(const std::string& name, int value) {
-    glUniform1i(glGetUniformLocation(mProgramId, name.c_str()), value);
+void CompoundShader::setValue(Uniform<glm::mat4> uniform, const glm::mat4& value) {
+    if (present(uniform.location))
+        glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
-void CompoundShader::setValue(const std::string& name, const glm::vec2& value) {
-    glUniform2f(glGetUniformLocation(mProgramId, name.c_str()), value.x, value.y);
+unsigned CompoundShader::missedWrites() {
+    return mMissedWrites;
 }
 
-void CompoundShader::setValue(const std::string& name, const glm::vec3& value) {
-    glUniform3f(glGetUniformLocation(mProgramId, name.c_str()), value.x, value.y, value.z);
+void CompoundShader::reflectUniforms() {
+    int count, maxLength;
+    glGetProgramiv(mProgramId, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(mProgramId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    char name[maxLength + 1];
+    mUniforms.reserve(count);
+
+    for (int i = 0; i < count; i++) {
+        int length, size;
+        unsigned type;
+        glGetActiveUniform(mProgramId, i, maxLength + 1, &length, &size, &type, name);
+
+        const int location = glGetUniformLocation(mProgramId, name);
+        if (location < 0) continue; // members of uniform blocks have no location
+
+        std::string_view view(name, length);
+        if (view.ends_with("[0]"))
+            view.remove_suffix(3);
+
+        mUniforms.push_back(UniformInfo{uniformHash(view), location, type});
+    }
+
+    std::sort(mUniforms.begin(), mUniforms.end(), [](const UniformInfo& a, const UniformInfo& b) { return a.hash < b.hash; });
+    assert(std::adjacent_find(mUniforms.begin(), mUniforms.end(), [](const UniformInfo& a, const UniformInfo& b) { return a.hash == b.hash; }) == mUniforms.end());
 }
 
-void CompoundShader::setValue(const std::string& name, const glm::vec4& value) {
-    glUniform4f(glGetUniformLocation(mProgramId, name.c_str()), value.x, value.y, value.z, value.w);
+static bool isSampler(unsigned type) {
+    return type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_SHADOW || type == GL_UNSIGNED_INT_SAMPLER_2D;
 }
 
-void CompoundShader::setValue(const std::string& name, const glm::mat3& value) {
-    glUniformMatrix3fv(glGetUniformLocation(mProgramId, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+int CompoundShader::locate(unsigned hash, unsigned type) {
+    const auto info = std::lower_bound(mUniforms.begin(), mUniforms.end(), hash, [](const UniformInfo& a, unsigned b) { return a.hash < b; });
+    if (info == mUniforms.end() || info->hash != hash) return -1;
+
+    assert(info->type == type || (type == GL_INT && isSampler(info->type))); // samplers are set as ints
+    return info->location;
 }
 
-void CompoundShader::setValue(const std::string& name, const glm::mat4& value) {
-    glUniformMatrix4fv(glGetUniformLocation(mProgramId, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+bool CompoundShader::present(int location) {
+    if (location >= 0) {
+        gStats.count(Stats::UNIFORM_UPLOADS);
+        return true;
+    }
+#ifndef NDEBUG
+    mMissedWrites++;
+#endif
+    return false;
 }
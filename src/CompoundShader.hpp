@@ -19,14 +19,46 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+// FNV-1a, usable in constant expressions so the names of the uniforms used every frame can be hashed at compile time
+constexpr unsigned uniformHash(std::string_view name) {
+    unsigned hash = 2166136261u;
+    for (const char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+struct Uniform {
+    int location = -1;
+};
+
+// the texts of both stages, read off the GL thread
+struct ShaderSources {
+    std::string vertex, fragment;
+};
+
 class CompoundShader final {
 private:
+    struct UniformInfo {
+        unsigned hash;
+        int location;
+        unsigned type;
+    };
+
     unsigned mProgramId;
+    std::vector<UniformInfo> mUniforms;
+    unsigned mMissedWrites;
 public:
     CompoundShader(const std::string& vertexPath, const std::string& fragmentPath);
+    explicit CompoundShader(const ShaderSources& sources);
     CompoundShader(const CompoundShader&) = delete;
     CompoundShader(CompoundShader&&) = delete;
 
@@ -35,13 +67,45 @@ public:
     CompoundShader& operator =(const CompoundShader&) = delete;
     CompoundShader& operator =(CompoundShader&&) = delete;
 
+    template <typename T>
+    Uniform<T> uniform(unsigned hash) {
+        return Uniform<T>{locate(hash, glType<T>())};
+    }
+
+    template <typename T>
+    Uniform<T> uniform(std::string_view name) {
+        return uniform<T>(uniformHash(name));
+    }
+
+    static ShaderSources readSources(const std::string& vertexPath, const std::string& fragmentPath);
+    static std::string readSource(const std::string& path);
+    static std::string withDefines(const std::string& source, const std::vector<std::string>& defines);
     void use();
-    void setValue(const std::string& name, bool value);
-    void setValue(const std::string& name, float value);
-    void setValue(const std::string& name, int value);
-    void setValue(const std::string& name, const glm::vec2& value);
-    void setValue(const std::string& name, const glm::vec3& value);
-    void setValue(const std::string& name, const glm::vec4& value);
-    void setValue(const std::string& name, const glm::mat3& value);
-    void setValue(const std::string& name, const glm::mat4& value);
+    unsigned program();
+    void bindUniformBlock(const char* name, unsigned binding);
+    void setValue(Uniform<bool> uniform, bool value);
+    void setValue(Uniform<float> uniform, float value);
+    void setValue(Uniform<int> uniform, int value);
+    void setValue(Uniform<glm::vec2> uniform, const glm::vec2& value);
+    void setValue(Uniform<glm::vec3> uniform, const glm::vec3& value);
+    void setValue(Uniform<glm::vec4> uniform, const glm::vec4& value);
+    void setValue(Uniform<glm::mat3> uniform, const glm::mat3& value);
+    void setValue(Uniform<glm::mat4> uniform, const glm::mat4& value);
+    unsigned missedWrites();
+private:
+    void reflectUniforms();
+    int locate(unsigned hash, unsigned type);
+    bool present(int location);
+
+    template <typename T>
+    static constexpr unsigned glType() {
+        if constexpr (std::is_same_v<T, bool>) return GL_BOOL;
+        else if constexpr (std::is_same_v<T, float>) return GL_FLOAT;
+        else if constexpr (std::is_same_v<T, int>) return GL_INT;
+        else if constexpr (std::is_same_v<T, glm::vec2>) return GL_FLOAT_VEC2;
+        else if constexpr (std::is_same_v<T, glm::vec3>) return GL_FLOAT_VEC3;
+        else if constexpr (std::is_same_v<T, glm::vec4>) return GL_FLOAT_VEC4;
+        else if constexpr (std::is_same_v<T, glm::mat3>) return GL_FLOAT_MAT3;
+        else return GL_FLOAT_MAT4;
+    }
 };
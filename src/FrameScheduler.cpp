@@ -0,0 +1,83 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "FrameScheduler.hpp"
+
+FrameScheduler::FrameScheduler(Mode mode) :
+    mMode(mode),
+    mRedraw(true),
+    mInputTimestamp(0),
+    mInputPending(false),
+    mLatencySamples(0),
+    mLatencyTotal(0),
+    mLatencyMax(0)
+{
+    setMode(mode);
+}
+
+void FrameScheduler::setMode(Mode mode) {
+    mMode = mode;
+    mRedraw = true;
+
+    // vsync alone paces the frames, sleeping on top of it only adds latency
+    SDL_GL_SetSwapInterval(mode == UNCAPPED ? 0 : 1);
+}
+
+FrameScheduler::Mode FrameScheduler::mode() {
+    return mMode;
+}
+
+// drains the queue for the frame about to be drawn, in the on-demand mode it sleeps in SDL_WaitEvent until something asks for a redraw
+bool FrameScheduler::nextEvent(SDL_Event* event) {
+    if (mMode == ON_DEMAND && !mRedraw)
+        return SDL_WaitEvent(event) == 1;
+    return SDL_PollEvent(event) == 1;
+}
+
+void FrameScheduler::requestRedraw() {
+    mRedraw = true;
+}
+
+// the latency is measured from the oldest input whose effect hasn't been presented yet
+void FrameScheduler::inputHandled(const SDL_Event& event) {
+    if (!mInputPending) {
+        mInputTimestamp = event.key.timestamp;
+        mInputPending = true;
+    }
+    mRedraw = true;
+}
+
+void FrameScheduler::presented() {
+    mRedraw = false;
+    if (!mInputPending) return;
+    mInputPending = false;
+
+    const Uint32 latency = SDL_GetTicks() - mInputTimestamp;
+    mLatencySamples++;
+    mLatencyTotal += latency;
+    if (latency > mLatencyMax)
+        mLatencyMax = latency;
+}
+
+float FrameScheduler::averageLatency() {
+    return mLatencySamples == 0 ? 0.0f : static_cast<float>(mLatencyTotal) / static_cast<float>(mLatencySamples);
+}
+
+float FrameScheduler::maxLatency() {
+    return static_cast<float>(mLatencyMax);
+}
@@ -0,0 +1,53 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <SDL2/SDL.h>
+
+class FrameScheduler final {
+public:
+    enum Mode {
+        ON_DEMAND,
+        VSYNC,
+        UNCAPPED
+    };
+private:
+    Mode mMode;
+    bool mRedraw;
+    Uint32 mInputTimestamp;
+    bool mInputPending;
+    unsigned mLatencySamples;
+    Uint32 mLatencyTotal, mLatencyMax;
+public:
+    explicit FrameScheduler(Mode mode);
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler(FrameScheduler&&) = delete;
+
+    FrameScheduler& operator =(const FrameScheduler&) = delete;
+    FrameScheduler& operator =(FrameScheduler&&) = delete;
+
+    void setMode(Mode mode);
+    Mode mode();
+    bool nextEvent(SDL_Event* event);
+    void requestRedraw();
+    void inputHandled(const SDL_Event& event);
+    void presented();
+    float averageLatency();
+    float maxLatency();
+};
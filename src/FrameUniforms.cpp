@@ -0,0 +1,61 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "FrameUniforms.hpp"
+#include "Stats.hpp"
+#include <cstddef>
+#include <GL/glew.h>
+#include <glm/gtc/type_ptr.hpp>
+
+static_assert(sizeof(glm::mat4) == 64 && sizeof(glm::vec4) == 16, "std140 layout mismatch");
+
+FrameUniforms::FrameUniforms() : mUbo(0) {
+    glGenBuffers(1, &mUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, mUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, mUbo);
+}
+
+FrameUniforms::~FrameUniforms() {
+    glDeleteBuffers(1, &mUbo);
+}
+
+void FrameUniforms::setCamera(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPos) {
+    const glm::vec4 position(viewPos, 1.0f);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, mUbo);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, projection), sizeof(glm::mat4), glm::value_ptr(projection));
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, view), sizeof(glm::mat4), glm::value_ptr(view));
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, viewPos), sizeof(glm::vec4), glm::value_ptr(position));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    gStats.count(Stats::UNIFORM_UPLOADS, 3);
+}
+
+void FrameUniforms::setLight(const glm::mat4& lightSpaceMatrix, const glm::vec3& lightPos) {
+    const glm::vec4 position(lightPos, 1.0f);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, mUbo);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, lightSpaceMatrix), sizeof(glm::mat4), glm::value_ptr(lightSpaceMatrix));
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, lightPos), sizeof(glm::vec4), glm::value_ptr(position));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    gStats.count(Stats::UNIFORM_UPLOADS, 2);
+}
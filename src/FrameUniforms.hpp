@@ -0,0 +1,49 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+// mirrors the std140 Frame uniform block declared in the shaders
+class FrameUniforms final {
+public:
+    static const unsigned BINDING = 0;
+private:
+    struct Block {
+        glm::mat4 projection;
+        glm::mat4 view;
+        glm::vec4 viewPos;
+        glm::mat4 lightSpaceMatrix;
+        glm::vec4 lightPos;
+    };
+
+    unsigned mUbo;
+public:
+    FrameUniforms();
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms(FrameUniforms&&) = delete;
+
+    ~FrameUniforms();
+
+    FrameUniforms& operator =(const FrameUniforms&) = delete;
+    FrameUniforms& operator =(FrameUniforms&&) = delete;
+
+    void setCamera(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPos);
+    void setLight(const glm::mat4& lightSpaceMatrix, const glm::vec3& lightPos);
+};
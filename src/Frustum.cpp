@@ -0,0 +1,53 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Frustum.hpp"
+
+Frustum::Frustum(const glm::mat4& viewProjection) : mPlanes() {
+    const glm::mat4 rows = glm::transpose(viewProjection);
+
+    for (int axis = 0; axis < 3; axis++) {
+        mPlanes[axis * 2] = rows[3] + rows[axis];
+        mPlanes[axis * 2 + 1] = rows[3] - rows[axis];
+    }
+
+    for (auto& plane : mPlanes)
+        plane = plane / glm::length(glm::vec3(plane));
+}
+
+// conservative, the sphere settles most boxes and only those it straddles a plane of get the box test against it
+bool Frustum::intersects(const Bounds& bounds) const {
+    if (bounds.min.x > bounds.max.x) return false;
+
+    for (const auto& plane : mPlanes) {
+        const glm::vec3 normal(plane);
+        const float distance = glm::dot(normal, bounds.center) + plane.w;
+
+        if (distance < -bounds.radius) return false;
+        if (distance >= bounds.radius) continue;
+
+        // the corner furthest along the normal
+        const glm::vec3 corner(
+            normal.x >= 0.0f ? bounds.max.x : bounds.min.x,
+            normal.y >= 0.0f ? bounds.max.y : bounds.min.y,
+            normal.z >= 0.0f ? bounds.max.z : bounds.min.z
+        );
+        if (glm::dot(normal, corner) + plane.w < 0.0f) return false;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GlState.hpp"
+#include "Stats.hpp"
+#include <GL/glew.h>
+
+GlState gGlState;
+
+void GlState::useProgram(unsigned program) {
+    if (program == mProgram) {
+        gStats.count(Stats::ELIDED_PROGRAM_BINDS);
+        return;
+    }
+
+    mProgram = program;
+    gStats.count(Stats::PROGRAM_BINDS);
+    glUseProgram(program);
+}
+
+void GlState::bindVertexArray(unsigned vertexArray) {
+    if (vertexArray == mVertexArray) {
+        gStats.count(Stats::ELIDED_VERTEX_ARRAY_BINDS);
+        return;
+    }
+
+    mVertexArray = vertexArray;
+    glBindVertexArray(vertexArray);
+}
+
+void GlState::setDepthTest(bool enabled) {
+    if (static_cast<unsigned>(enabled) == mDepthTest) {
+        gStats.count(Stats::ELIDED_STATE_CHANGES);
+        return;
+    }
+
+    mDepthTest = enabled;
+    if (enabled)
+        glEnable(GL_DEPTH_TEST);
+    else
+        glDisable(GL_DEPTH_TEST);
+}
+
+// deleting what's bound unbinds it, and the name may come back with something else
+void GlState::deleteProgram(unsigned program) {
+    if (program == mProgram) mProgram = UNKNOWN;
+    glDeleteProgram(program);
+}
+
+void GlState::deleteVertexArray(unsigned vertexArray) {
+    if (vertexArray == mVertexArray) mVertexArray = UNKNOWN;
+    glDeleteVertexArrays(1, &vertexArray);
+}
@@ -0,0 +1,44 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// mirrors the pieces of GL state that change between draws and drops the calls that wouldn't change anything,
+// whatever binds programs or vertex arrays or touches the depth test has to go through it
+class GlState final {
+private:
+    static const unsigned UNKNOWN = ~0u;
+
+    unsigned mProgram = UNKNOWN, mVertexArray = UNKNOWN;
+    unsigned mDepthTest = UNKNOWN;
+public:
+    GlState() = default;
+    GlState(const GlState&) = delete;
+    GlState(GlState&&) = delete;
+
+    GlState& operator =(const GlState&) = delete;
+    GlState& operator =(GlState&&) = delete;
+
+    void useProgram(unsigned program);
+    void bindVertexArray(unsigned vertexArray);
+    void setDepthTest(bool enabled);
+    void deleteProgram(unsigned program);
+    void deleteVertexArray(unsigned vertexArray);
+};
+
+extern GlState gGlState;
@@ -0,0 +1,82 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HeadlessContext.hpp"
+#include <cassert>
+#include <GL/glew.h>
+#include <EGL/eglext.h>
+
+HeadlessContext::HeadlessContext(int width, int height) :
+    mDisplay(EGL_NO_DISPLAY),
+    mContext(EGL_NO_CONTEXT),
+    mFbo(0),
+    mColorBuffer(0),
+    mDepthStencilBuffer(0)
+{
+    const auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    assert(getPlatformDisplay != nullptr);
+
+    mDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    assert(mDisplay != EGL_NO_DISPLAY);
+    assert(eglInitialize(mDisplay, nullptr, nullptr) == EGL_TRUE);
+    assert(eglBindAPI(EGL_OPENGL_API) == EGL_TRUE);
+
+    const EGLint attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    mContext = eglCreateContext(mDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+    assert(mContext != EGL_NO_CONTEXT);
+    assert(eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, mContext) == EGL_TRUE);
+
+    // glewInit() insists on a GLX display, the context itself is all that's needed here
+    glewExperimental = GL_TRUE;
+    assert(glewContextInit() == GLEW_OK);
+
+    glGenRenderbuffers(1, &mColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, mColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &mDepthStencilBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, mDepthStencilBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &mFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, mDepthStencilBuffer);
+    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+}
+
+HeadlessContext::~HeadlessContext() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &mFbo);
+    glDeleteRenderbuffers(1, &mColorBuffer);
+    glDeleteRenderbuffers(1, &mDepthStencilBuffer);
+
+    eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(mDisplay, mContext);
+    eglTerminate(mDisplay);
+}
+
+unsigned HeadlessContext::framebuffer() {
+    return mFbo;
+}
@@ -0,0 +1,40 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <EGL/egl.h>
+
+// a surfaceless EGL context rendering into an offscreen framebuffer, runs on Mesa llvmpipe without any display or GPU
+class HeadlessContext final {
+private:
+    EGLDisplay mDisplay;
+    EGLContext mContext;
+    unsigned mFbo, mColorBuffer, mDepthStencilBuffer;
+public:
+    HeadlessContext(int width, int height);
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext(HeadlessContext&&) = delete;
+
+    ~HeadlessContext();
+
+    HeadlessContext& operator =(const HeadlessContext&) = delete;
+    HeadlessContext& operator =(HeadlessContext&&) = delete;
+
+    unsigned framebuffer();
+};
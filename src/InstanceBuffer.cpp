@@ -0,0 +1,80 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "InstanceBuffer.hpp"
+#include <cstddef>
+#include <GL/glew.h>
+
+static const unsigned MODEL_LOCATION = 2, COLOR_LOCATION = 6, NORMAL_LOCATION = 7;
+
+InstanceBuffer::InstanceBuffer() : mVbo(0), mInstances(), mDirty(false) {
+    glGenBuffers(1, &mVbo);
+}
+
+InstanceBuffer::~InstanceBuffer() {
+    glDeleteBuffers(1, &mVbo);
+}
+
+void InstanceBuffer::clear() {
+    mInstances.clear();
+    mDirty = true;
+}
+
+void InstanceBuffer::add(const glm::mat4& model, const glm::vec3& color) {
+    mInstances.push_back(Instance{model, color, glm::transpose(glm::inverse(glm::mat3(model)))});
+    mDirty = true;
+}
+
+void InstanceBuffer::upload() {
+    if (!mDirty) return;
+    mDirty = false;
+
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+    glBufferData(GL_ARRAY_BUFFER, (long) (mInstances.size() * sizeof(Instance)), mInstances.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// expects the target vertex array to be bound already, the per-instance attributes become part of its state,
+// they start at the first instance since there's no base instance in GL 3.3
+void InstanceBuffer::bind(int first) {
+    const size_t offset = first * sizeof(Instance);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+
+    for (unsigned i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(MODEL_LOCATION + i);
+        glVertexAttribPointer(MODEL_LOCATION + i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), reinterpret_cast<void*>(offset + offsetof(Instance, Model) + i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(MODEL_LOCATION + i, 1);
+    }
+
+    glEnableVertexAttribArray(COLOR_LOCATION);
+    glVertexAttribPointer(COLOR_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), reinterpret_cast<void*>(offset + offsetof(Instance, Color)));
+    glVertexAttribDivisor(COLOR_LOCATION, 1);
+
+    for (unsigned i = 0; i < 3; i++) {
+        glEnableVertexAttribArray(NORMAL_LOCATION + i);
+        glVertexAttribPointer(NORMAL_LOCATION + i, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), reinterpret_cast<void*>(offset + offsetof(Instance, Normal) + i * sizeof(glm::vec3)));
+        glVertexAttribDivisor(NORMAL_LOCATION + i, 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+int InstanceBuffer::count() {
+    return (int) mInstances.size();
+}
@@ -0,0 +1,50 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+struct Instance {
+    glm::mat4 Model;
+    glm::vec3 Color;
+    glm::mat3 Normal;
+};
+
+class InstanceBuffer final {
+private:
+    unsigned mVbo;
+    std::vector<Instance> mInstances;
+    bool mDirty;
+public:
+    InstanceBuffer();
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer(InstanceBuffer&&) = delete;
+
+    ~InstanceBuffer();
+
+    InstanceBuffer& operator =(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator =(InstanceBuffer&&) = delete;
+
+    void clear();
+    void add(const glm::mat4& model, const glm::vec3& color);
+    void upload();
+    void bind(int first);
+    int count();
+};
@@ -17,50 +17,103 @@
  */
 
 #include "Mesh.hpp"
-#include <memory>
-
-Mesh::Mesh(
-    std::vector<Vertex>&& vertices,
-    std::vector<unsigned>&& indices
-) :
-    mVao(0),
-    mVbo(0),
-    mEbo(0),
-    mVertices(std::move(vertices)),
-    mIndices(std::move(indices))
+#include "MeshArena.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <GL/glew.h>
+
+static_assert(Stats::LOD3_TRIANGLES - Stats::LOD0_TRIANGLES + 1 == Mesh::MAX_LODS);
+
+// the data is only read for the upload, so it can come straight from a memory mapped cache file,
+// encode maps model space into the [-1, 1] range used by POSITION_SNORM16
+Mesh::Mesh(MeshArena* arena, std::span<const Vertex> vertices, std::span<const unsigned char> indices, unsigned indexType, std::span<const Lod> lods, const glm::mat4& encode) :
+    mArena(arena),
+    mBaseVertex(arena->addVertices(vertices, encode)),
+    mIndexOffset(arena->addIndices(indices)),
+    mIndexType(indexType),
+    mLods(lods.begin(), lods.end()),
+    mBounds(Bounds::empty())
 {
-    glGenVertexArrays(1, &mVao);
-    glGenBuffers(1, &mVbo);
-    glGenBuffers(1, &mEbo);
+    for (const auto& vertex : vertices) {
+        mBounds.min = glm::min(mBounds.min, vertex.Position);
+        mBounds.max = glm::max(mBounds.max, vertex.Position);
+    }
+
+    mBounds.center = (mBounds.min + mBounds.max) * 0.5f;
+    for (const auto& vertex : vertices)
+        mBounds.radius = std::max(mBounds.radius, glm::length(vertex.Position - mBounds.center));
+}
+
+// the program and its uniforms are expected to be set up already
+void Mesh::draw(int lod) {
+    const Lod& range = level(lod);
 
-    glBindVertexArray(mVao);
+    mArena->bind();
+    glDrawElementsBaseVertex(GL_TRIANGLES, (int) range.indexCount, mIndexType, reinterpret_cast<void*>(mIndexOffset + range.indexOffset * indexSize()), mBaseVertex);
 
-    glBindBuffer(GL_ARRAY_BUFFER, mVbo);
-    glBufferData(GL_ARRAY_BUFFER, (long) (mVertices.size() * sizeof(Vertex)), &(mVertices[0]), GL_STATIC_DRAW);
+    gStats.count(Stats::DRAW_CALLS);
+    count(lod, 1);
+}
+
+// draws instances [first, first + count) of the buffer
+void Mesh::drawInstanced(InstanceBuffer* instances, int lod, int first, int count) {
+    if (count == 0) return;
+    const Lod& range = level(lod);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEbo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (long) (mIndices.size() * sizeof(unsigned)), &(mIndices[0]), GL_STATIC_DRAW);
+    mArena->bind();
+    instances->bind(first);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (int) range.indexCount, mIndexType, reinterpret_cast<void*>(mIndexOffset + range.indexOffset * indexSize()), count, mBaseVertex);
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(0));
+    gStats.count(Stats::DRAW_CALLS);
+    this->count(lod, count);
+}
 
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Normal)));
+// the same draw as drawInstanced for MeshArena::multiDraw, which issues it together with others
+DrawCommand Mesh::command(int lod, int first, int count) {
+    const Lod& range = level(lod);
+    this->count(lod, count);
+
+    return DrawCommand{
+        range.indexCount,
+        (unsigned) count,
+        (unsigned) (mIndexOffset / indexSize() + range.indexOffset),
+        mBaseVertex,
+        (unsigned) first
+    };
+}
 
-    glBindVertexArray(0);
+int Mesh::lodCount() {
+    return (int) mLods.size();
 }
 
-Mesh::~Mesh() {
-    glDeleteVertexArrays(1, &mVao);
-    glDeleteBuffers(1, &mVbo);
-    glDeleteBuffers(1, &mEbo);
+float Mesh::lodError(int lod) {
+    return level(lod).error;
 }
 
-void Mesh::draw(CompoundShader* shader, const glm::vec4& color) {
-    shader->use();
-    shader->setValue("objectColor", color);
+MeshArena* Mesh::arena() {
+    return mArena;
+}
+
+unsigned Mesh::indexType() {
+    return mIndexType;
+}
+
+// in model space, before the quantization of POSITION_SNORM16
+const Bounds& Mesh::bounds() {
+    return mBounds;
+}
+
+// meshes with a shorter chain than the model's draw their coarsest level
+const Lod& Mesh::level(int lod) {
+    return mLods[std::min(lod, (int) mLods.size() - 1)];
+}
+
+size_t Mesh::indexSize() {
+    return mIndexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned);
+}
 
-    glBindVertexArray(mVao);
-    glDrawElements(GL_TRIANGLES, (int) mIndices.size(), GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
-    glBindVertexArray(0);
+void Mesh::count(int lod, int instances) {
+    const Lod& range = level(lod);
+    gStats.count(Stats::TRIANGLES, range.indexCount / 3 * instances);
+    gStats.count(static_cast<Stats::Counter>(Stats::LOD0_TRIANGLES + (&range - mLods.data())), range.indexCount / 3 * instances);
 }
@@ -18,7 +18,10 @@
 
 #pragma once
 
-#include "CompoundShader.hpp"
+#include "Bounds.hpp"
+#include "InstanceBuffer.hpp"
+#include <cstddef>
+#include <span>
 #include <string>
 #include <vector>
 #include <glm/glm.hpp>
@@ -28,27 +31,74 @@ struct Vertex {
     glm::vec3 Normal;
 };
 
+// a range of the index buffer drawing the mesh at a lower detail, error is the largest deviation from the full mesh in model units
+struct Lod {
+    unsigned indexOffset, indexCount;
+    float error;
+};
+
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned> indices;
+    std::vector<Lod> lods;
+};
+
+// how the vertex streams are stored on the GPU, positions and normals live in separate buffers
+// so the depth and outline passes only fetch positions
+enum PositionFormat {
+    POSITION_FLOAT,
+    POSITION_HALF,
+    POSITION_SNORM16 // quantized against the model bounds, the model's decode matrix maps it back
+};
+
+enum NormalFormat {
+    NORMAL_FLOAT,
+    NORMAL_PACKED // GL_INT_2_10_10_10_REV
+};
+
+struct VertexLayout {
+    PositionFormat position;
+    NormalFormat normal;
+};
+
 struct Texture {
     unsigned int id;
     std::string type;
     std::string path;
 };
 
+class MeshArena;
+struct DrawCommand;
+
+// a range of vertices and indices in an arena, the space stays taken as long as the arena lives
 class Mesh {
 private:
-    unsigned mVao, mVbo, mEbo;
-public:
-    std::vector<Vertex> mVertices;
-    std::vector<unsigned> mIndices;
+    MeshArena* mArena;
+    int mBaseVertex;
+    size_t mIndexOffset;
+    unsigned mIndexType;
+    std::vector<Lod> mLods;
+    Bounds mBounds;
 public:
-    Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned>&& indices);
+    static const int MAX_LODS = 4;
+
+    Mesh(MeshArena* arena, std::span<const Vertex> vertices, std::span<const unsigned char> indices, unsigned indexType, std::span<const Lod> lods, const glm::mat4& encode);
     Mesh(const Mesh&) = delete;
     Mesh(Mesh&&) = delete;
 
-    ~Mesh();
-
     Mesh& operator =(const Mesh&) = delete;
     Mesh& operator =(Mesh&&) = delete;
 
-    void draw(CompoundShader* shader, const glm::vec4& color);
+    void draw(int lod);
+    void drawInstanced(InstanceBuffer* instances, int lod, int first, int count);
+    DrawCommand command(int lod, int first, int count);
+    int lodCount();
+    float lodError(int lod);
+    MeshArena* arena();
+    unsigned indexType();
+    const Bounds& bounds();
+private:
+    const Lod& level(int lod);
+    size_t indexSize();
+    void count(int lod, int instances);
 };
@@ -0,0 +1,235 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MeshArena.hpp"
+#include "GlState.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <GL/glew.h>
+#include <glm/gtc/packing.hpp>
+
+static const size_t INITIAL_VERTICES = 1 << 16, INITIAL_INDEX_BYTES = 1 << 20;
+
+static size_t positionStride(PositionFormat format) {
+    // both compact formats take 8 bytes with the fourth component as padding to keep the attribute aligned
+    return format == POSITION_FLOAT ? sizeof(glm::vec3) : sizeof(uint64_t);
+}
+
+static size_t normalStride(NormalFormat format) {
+    return format == NORMAL_FLOAT ? sizeof(glm::vec3) : sizeof(uint32_t);
+}
+
+// into the bound array buffer at the given vertex
+static void uploadPositions(std::span<const Vertex> vertices, PositionFormat format, const glm::mat4& encode, size_t first) {
+    if (format == POSITION_FLOAT) {
+        std::vector<glm::vec3> positions;
+        positions.reserve(vertices.size());
+        for (const auto& vertex : vertices)
+            positions.push_back(vertex.Position);
+
+        glBufferSubData(GL_ARRAY_BUFFER, (long) (first * sizeof(glm::vec3)), (long) (positions.size() * sizeof(glm::vec3)), positions.data());
+        return;
+    }
+
+    std::vector<uint64_t> positions;
+    positions.reserve(vertices.size());
+    for (const auto& vertex : vertices) {
+        if (format == POSITION_HALF)
+            positions.push_back(glm::packHalf4x16(glm::vec4(vertex.Position, 1.0f)));
+        else
+            positions.push_back(glm::packSnorm4x16(encode * glm::vec4(vertex.Position, 1.0f)));
+    }
+
+    glBufferSubData(GL_ARRAY_BUFFER, (long) (first * sizeof(uint64_t)), (long) (positions.size() * sizeof(uint64_t)), positions.data());
+}
+
+static void uploadNormals(std::span<const Vertex> vertices, NormalFormat format, size_t first) {
+    if (format == NORMAL_FLOAT) {
+        std::vector<glm::vec3> normals;
+        normals.reserve(vertices.size());
+        for (const auto& vertex : vertices)
+            normals.push_back(vertex.Normal);
+
+        glBufferSubData(GL_ARRAY_BUFFER, (long) (first * sizeof(glm::vec3)), (long) (normals.size() * sizeof(glm::vec3)), normals.data());
+        return;
+    }
+
+    std::vector<uint32_t> normals;
+    normals.reserve(vertices.size());
+    for (const auto& vertex : vertices)
+        normals.push_back(glm::packSnorm3x10_1x2(glm::vec4(vertex.Normal, 0.0f)));
+
+    glBufferSubData(GL_ARRAY_BUFFER, (long) (first * sizeof(uint32_t)), (long) (normals.size() * sizeof(uint32_t)), normals.data());
+}
+
+// multi draw needs base instances as well, the per-instance attributes can't be moved between the draws of one call
+MeshArena::MeshArena(const VertexLayout& layout, bool multiDraw) :
+    mLayout(layout),
+    mPositionStride(positionStride(layout.position)),
+    mNormalStride(normalStride(layout.normal)),
+    mVao(0),
+    mPositionVbo(0),
+    mNormalVbo(0),
+    mEbo(0),
+    mIndirectBuffer(0),
+    mVertexCapacity(INITIAL_VERTICES),
+    mVertexCount(0),
+    mIndexCapacity(INITIAL_INDEX_BYTES),
+    mIndexSize(0),
+    mMultiDraw(multiDraw && (GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance)))
+{
+    glGenVertexArrays(1, &mVao);
+    glGenBuffers(1, &mPositionVbo);
+    glGenBuffers(1, &mNormalVbo);
+    glGenBuffers(1, &mEbo);
+    glGenBuffers(1, &mIndirectBuffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mPositionVbo);
+    glBufferData(GL_ARRAY_BUFFER, (long) (mVertexCapacity * mPositionStride), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, mNormalVbo);
+    glBufferData(GL_ARRAY_BUFFER, (long) (mVertexCapacity * mNormalStride), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    bind();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (long) mIndexCapacity, nullptr, GL_STATIC_DRAW);
+    setAttributes();
+}
+
+MeshArena::~MeshArena() {
+    gGlState.deleteVertexArray(mVao);
+    glDeleteBuffers(1, &mPositionVbo);
+    glDeleteBuffers(1, &mNormalVbo);
+    glDeleteBuffers(1, &mEbo);
+    glDeleteBuffers(1, &mIndirectBuffer);
+}
+
+// returns the base vertex the mesh's indices are relative to, the space is never given back
+int MeshArena::addVertices(std::span<const Vertex> vertices, const glm::mat4& encode) {
+    if (mVertexCount + vertices.size() > mVertexCapacity)
+        growVertices(std::max(mVertexCapacity * 2, mVertexCount + vertices.size()));
+
+    const size_t first = mVertexCount;
+    mVertexCount += vertices.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, mPositionVbo);
+    uploadPositions(vertices, mLayout.position, encode, first);
+    glBindBuffer(GL_ARRAY_BUFFER, mNormalVbo);
+    uploadNormals(vertices, mLayout.normal, first);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return (int) first;
+}
+
+// returns the byte offset of the indices, every range starts 4 byte aligned so it fits both index types
+size_t MeshArena::addIndices(std::span<const unsigned char> indices) {
+    const size_t first = (mIndexSize + 3) & ~static_cast<size_t>(3);
+    if (first + indices.size_bytes() > mIndexCapacity)
+        growIndices(std::max(mIndexCapacity * 2, first + indices.size_bytes()));
+
+    mIndexSize = first + indices.size_bytes();
+
+    bind();
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (long) first, (long) indices.size_bytes(), indices.data());
+    return first;
+}
+
+void MeshArena::bind() {
+    gGlState.bindVertexArray(mVao);
+}
+
+// the instances are addressed through the commands' base instance, so their attributes start at the first one
+void MeshArena::multiDraw(InstanceBuffer* instances, unsigned indexType, std::span<const DrawCommand> commands) {
+    bind();
+    instances->bind(0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, (long) commands.size_bytes(), commands.data(), GL_STREAM_DRAW);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, nullptr, (int) commands.size(), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    gStats.count(Stats::DRAW_CALLS);
+}
+
+bool MeshArena::multiDrawSupported() {
+    return mMultiDraw;
+}
+
+unsigned MeshArena::vertexArray() {
+    return mVao;
+}
+
+const VertexLayout& MeshArena::layout() {
+    return mLayout;
+}
+
+void MeshArena::setAttributes() {
+    bind();
+
+    glBindBuffer(GL_ARRAY_BUFFER, mPositionVbo);
+    glEnableVertexAttribArray(0);
+    if (mLayout.position == POSITION_FLOAT)
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, (int) mPositionStride, reinterpret_cast<void*>(0));
+    else if (mLayout.position == POSITION_HALF)
+        glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, (int) mPositionStride, reinterpret_cast<void*>(0));
+    else
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, (int) mPositionStride, reinterpret_cast<void*>(0));
+
+    glBindBuffer(GL_ARRAY_BUFFER, mNormalVbo);
+    glEnableVertexAttribArray(1);
+    if (mLayout.normal == NORMAL_FLOAT)
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, (int) mNormalStride, reinterpret_cast<void*>(0));
+    else
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, (int) mNormalStride, reinterpret_cast<void*>(0));
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// the attributes point at the buffer objects, so they're set again once the buffers are replaced
+void MeshArena::growVertices(size_t capacity) {
+    mPositionVbo = grow(mPositionVbo, mVertexCount * mPositionStride, capacity * mPositionStride);
+    mNormalVbo = grow(mNormalVbo, mVertexCount * mNormalStride, capacity * mNormalStride);
+    mVertexCapacity = capacity;
+    setAttributes();
+}
+
+// the index buffer binding is part of the vertex array
+void MeshArena::growIndices(size_t capacity) {
+    mEbo = grow(mEbo, mIndexSize, capacity);
+    mIndexCapacity = capacity;
+
+    bind();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEbo);
+}
+
+// copies what's used into a new buffer of the given capacity and deletes the old one
+unsigned MeshArena::grow(unsigned buffer, size_t used, size_t capacity) {
+    unsigned grown;
+    glGenBuffers(1, &grown);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, (long) capacity, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (long) used);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    return grown;
+}
@@ -0,0 +1,66 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "InstanceBuffer.hpp"
+#include "Mesh.hpp"
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+// the layout glMultiDrawElementsIndirect reads its draws in
+struct DrawCommand {
+    unsigned count, instanceCount, firstIndex;
+    int baseVertex;
+    unsigned baseInstance;
+};
+
+// one vertex array with one buffer per vertex stream and one index buffer that all meshes are sub-allocated from,
+// meshes draw with a base vertex so switching between them doesn't touch any bindings
+class MeshArena final {
+private:
+    const VertexLayout mLayout;
+    const size_t mPositionStride, mNormalStride;
+    unsigned mVao, mPositionVbo, mNormalVbo, mEbo, mIndirectBuffer;
+    size_t mVertexCapacity, mVertexCount, mIndexCapacity, mIndexSize;
+    bool mMultiDraw;
+public:
+    MeshArena(const VertexLayout& layout, bool multiDraw);
+    MeshArena(const MeshArena&) = delete;
+    MeshArena(MeshArena&&) = delete;
+
+    ~MeshArena();
+
+    MeshArena& operator =(const MeshArena&) = delete;
+    MeshArena& operator =(MeshArena&&) = delete;
+
+    int addVertices(std::span<const Vertex> vertices, const glm::mat4& encode);
+    size_t addIndices(std::span<const unsigned char> indices);
+    void bind();
+    void multiDraw(InstanceBuffer* instances, unsigned indexType, std::span<const DrawCommand> commands);
+    bool multiDrawSupported();
+    unsigned vertexArray();
+    const VertexLayout& layout();
+private:
+    void setAttributes();
+    void growVertices(size_t capacity);
+    void growIndices(size_t capacity);
+    static unsigned grow(unsigned buffer, size_t used, size_t capacity);
+};
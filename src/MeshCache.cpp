@@ -0,0 +1,191 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MeshCache.hpp"
+#include "MeshOptimizer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <GL/glew.h>
+
+static const char MAGIC[4] = {'J', 'M', 'S', 'H'};
+static const uint32_t VERSION = 3;
+static const size_t ALIGNMENT = 16;
+
+static std::string cachePath(const std::string& sourcePath) {
+    return sourcePath + ".jmesh";
+}
+
+static size_t indexSize(unsigned indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned);
+}
+
+static size_t align(size_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+MeshCache::MeshCache(const std::string& sourcePath) : mMapping(nullptr), mSize(0), mEntries(nullptr), mMeshCount(0) {
+    Header expected;
+    if (!sourceStamp(sourcePath, expected)) return;
+
+    const int file = open(cachePath(sourcePath).c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) return;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(Header)) {
+        close(file);
+        return;
+    }
+
+    mSize = static_cast<size_t>(status.st_size);
+    void* mapping = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED) return;
+    mMapping = mapping;
+
+    const auto header = static_cast<const Header*>(mMapping);
+    const auto bytes = static_cast<const unsigned char*>(mMapping);
+
+    bool fresh = memcmp(header->magic, MAGIC, sizeof MAGIC) == 0
+        && header->version == VERSION
+        && header->sourceSize == expected.sourceSize
+        && header->sourceModified == expected.sourceModified
+        && sizeof(Header) + header->meshCount * sizeof(Entry) <= mSize;
+
+    if (fresh) {
+        mEntries = reinterpret_cast<const Entry*>(bytes + sizeof(Header));
+        for (uint32_t i = 0; i < header->meshCount && fresh; i++) {
+            const Entry& entry = mEntries[i];
+            fresh = (entry.indexType == GL_UNSIGNED_SHORT || entry.indexType == GL_UNSIGNED_INT)
+                && entry.vertexOffset + entry.vertexCount * sizeof(Vertex) <= mSize
+                && entry.indexOffset + entry.indexCount * indexSize(entry.indexType) <= mSize
+                && entry.lodCount >= 1 && entry.lodCount <= Mesh::MAX_LODS;
+            for (uint32_t lod = 0; lod < entry.lodCount && fresh; lod++)
+                fresh = entry.lods[lod].indexOffset + entry.lods[lod].indexCount <= entry.indexCount;
+        }
+    }
+
+    if (!fresh) {
+        munmap(mMapping, mSize);
+        mMapping = nullptr;
+        mEntries = nullptr;
+        return;
+    }
+
+    mMeshCount = static_cast<int>(header->meshCount);
+    madvise(mMapping, mSize, MADV_SEQUENTIAL);
+}
+
+MeshCache::~MeshCache() {
+    if (mMapping != nullptr)
+        munmap(mMapping, mSize);
+}
+
+bool MeshCache::valid() {
+    return mMapping != nullptr;
+}
+
+int MeshCache::meshCount() {
+    return mMeshCount;
+}
+
+std::span<const Vertex> MeshCache::vertices(int mesh) {
+    const Entry& entry = mEntries[mesh];
+    return {reinterpret_cast<const Vertex*>(static_cast<const unsigned char*>(mMapping) + entry.vertexOffset), entry.vertexCount};
+}
+
+std::span<const unsigned char> MeshCache::indices(int mesh) {
+    const Entry& entry = mEntries[mesh];
+    return {static_cast<const unsigned char*>(mMapping) + entry.indexOffset, entry.indexCount * indexSize(entry.indexType)};
+}
+
+unsigned MeshCache::indexType(int mesh) {
+    return mEntries[mesh].indexType;
+}
+
+std::span<const Lod> MeshCache::lods(int mesh) {
+    return {mEntries[mesh].lods, mEntries[mesh].lodCount};
+}
+
+// written to a temporary file first so a reader never maps a half written cache
+bool MeshCache::write(const std::string& sourcePath, const std::vector<MeshData>& meshes) {
+    Header header;
+    if (!sourceStamp(sourcePath, header)) return false;
+
+    memcpy(header.magic, MAGIC, sizeof MAGIC);
+    header.version = VERSION;
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.reserved = 0;
+
+    std::vector<Entry> entries(meshes.size(), Entry{});
+    std::vector<std::vector<unsigned char>> packed(meshes.size());
+    size_t offset = align(sizeof(Header) + meshes.size() * sizeof(Entry));
+    for (size_t i = 0; i < meshes.size(); i++) {
+        entries[i].vertexCount = static_cast<uint32_t>(meshes[i].vertices.size());
+        entries[i].indexCount = static_cast<uint32_t>(meshes[i].indices.size());
+        entries[i].indexType = packIndices(meshes[i], packed[i]);
+        entries[i].lodCount = static_cast<uint32_t>(std::min(meshes[i].lods.size(), static_cast<size_t>(Mesh::MAX_LODS)));
+        std::copy_n(meshes[i].lods.begin(), entries[i].lodCount, entries[i].lods);
+
+        entries[i].vertexOffset = offset;
+        offset = align(offset + meshes[i].vertices.size() * sizeof(Vertex));
+
+        entries[i].indexOffset = offset;
+        offset = align(offset + packed[i].size());
+    }
+
+    std::vector<unsigned char> contents(offset, 0);
+    memcpy(contents.data(), &header, sizeof(Header));
+    memcpy(contents.data() + sizeof(Header), entries.data(), entries.size() * sizeof(Entry));
+    for (size_t i = 0; i < meshes.size(); i++) {
+        memcpy(contents.data() + entries[i].vertexOffset, meshes[i].vertices.data(), meshes[i].vertices.size() * sizeof(Vertex));
+        memcpy(contents.data() + entries[i].indexOffset, packed[i].data(), packed[i].size());
+    }
+
+    const std::string path = cachePath(sourcePath), temporaryPath = path + ".tmp";
+
+    const int file = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file < 0) return false;
+
+    size_t written = 0;
+    while (written < contents.size()) {
+        const ssize_t result = ::write(file, contents.data() + written, contents.size() - written);
+        if (result <= 0) break;
+        written += static_cast<size_t>(result);
+    }
+    close(file);
+
+    if (written != contents.size() || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        unlink(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::sourceStamp(const std::string& sourcePath, Header& header) {
+    struct stat status;
+    if (stat(sourcePath.c_str(), &status) != 0) return false;
+
+    header.sourceSize = static_cast<uint64_t>(status.st_size);
+    header.sourceModified = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+    return true;
+}
@@ -0,0 +1,70 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Mesh.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// a preprocessed copy of a model stored next to its source as <source>.jmesh,
+// it's memory mapped so the vertex and index arrays go to the driver without being parsed or copied
+class MeshCache final {
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceSize;
+        int64_t sourceModified;
+        uint32_t meshCount;
+        uint32_t reserved;
+    };
+
+    struct Entry {
+        uint32_t vertexCount, indexCount, indexType, lodCount;
+        uint64_t vertexOffset, indexOffset;
+        Lod lods[Mesh::MAX_LODS];
+    };
+
+    void* mMapping;
+    size_t mSize;
+    const Entry* mEntries;
+    int mMeshCount;
+public:
+    explicit MeshCache(const std::string& sourcePath);
+    MeshCache(const MeshCache&) = delete;
+    MeshCache(MeshCache&&) = delete;
+
+    ~MeshCache();
+
+    MeshCache& operator =(const MeshCache&) = delete;
+    MeshCache& operator =(MeshCache&&) = delete;
+
+    bool valid();
+    int meshCount();
+    std::span<const Vertex> vertices(int mesh);
+    std::span<const unsigned char> indices(int mesh);
+    unsigned indexType(int mesh);
+    std::span<const Lod> lods(int mesh);
+    static bool write(const std::string& sourcePath, const std::vector<MeshData>& meshes);
+private:
+    static bool sourceStamp(const std::string& sourcePath, Header& header);
+};
@@ -0,0 +1,530 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MeshOptimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <GL/glew.h>
+
+// the post-transform cache is modelled as a 16 entry FIFO when measuring and a 32 entry LRU when ordering, as in Forsyth's scheme
+static const int FIFO_SIZE = 16, LRU_SIZE = 32;
+
+struct VertexKey {
+    float values[6];
+
+    bool operator ==(const VertexKey& other) const {
+        return memcmp(values, other.values, sizeof values) == 0;
+    }
+};
+
+struct VertexKeyHash {
+    size_t operator ()(const VertexKey& key) const {
+        size_t hash = 14695981039346656037ull;
+        for (const float value : key.values) {
+            unsigned bits;
+            memcpy(&bits, &value, sizeof bits);
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+static void remapVertices(MeshData& mesh, const std::vector<unsigned>& remap, unsigned vertexCount) {
+    std::vector<Vertex> vertices(vertexCount);
+    for (size_t i = 0; i < mesh.vertices.size(); i++) {
+        if (remap[i] != ~0u)
+            vertices[remap[i]] = mesh.vertices[i];
+    }
+
+    for (auto& index : mesh.indices)
+        index = remap[index];
+
+    mesh.vertices = std::move(vertices);
+}
+
+// merges bitwise identical vertices, the OBJ importer emits one vertex per face corner
+void weldVertices(MeshData& mesh) {
+    std::unordered_map<VertexKey, unsigned, VertexKeyHash> unique;
+    unique.reserve(mesh.vertices.size());
+
+    std::vector<unsigned> remap(mesh.vertices.size());
+    unsigned vertexCount = 0;
+
+    for (size_t i = 0; i < mesh.vertices.size(); i++) {
+        const Vertex& vertex = mesh.vertices[i];
+        const VertexKey key{{vertex.Position.x, vertex.Position.y, vertex.Position.z, vertex.Normal.x, vertex.Normal.y, vertex.Normal.z}};
+
+        const auto [iterator, inserted] = unique.try_emplace(key, vertexCount);
+        if (inserted)
+            vertexCount++;
+        remap[i] = iterator->second;
+    }
+
+    remapVertices(mesh, remap, vertexCount);
+}
+
+static float cacheScore(int position, int remainingTriangles) {
+    if (remainingTriangles == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (position >= 0)
+        score = position < 3 ? 0.75f : std::pow(1.0f - static_cast<float>(position - 3) / (LRU_SIZE - 3), 1.5f);
+
+    return score + 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+}
+
+// Tom Forsyth's linear-speed vertex cache optimisation
+void optimizeVertexCache(std::vector<unsigned>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    std::vector<int> remaining(vertexCount, 0), offsets(vertexCount + 1, 0), cachePositions(vertexCount, -1);
+    for (const unsigned index : indices)
+        remaining[index]++;
+    for (size_t i = 0; i < vertexCount; i++)
+        offsets[i + 1] = offsets[i] + remaining[i];
+
+    std::vector<unsigned> adjacency(indices.size());
+    std::vector<int> filled(offsets.begin(), offsets.end() - 1);
+    for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+        for (int corner = 0; corner < 3; corner++) {
+            const unsigned vertex = indices[triangle * 3 + corner];
+            adjacency[filled[vertex]++] = static_cast<unsigned>(triangle);
+        }
+    }
+
+    std::vector<float> vertexScores(vertexCount), triangleScores(triangleCount);
+    for (size_t i = 0; i < vertexCount; i++)
+        vertexScores[i] = cacheScore(-1, remaining[i]);
+    for (size_t triangle = 0; triangle < triangleCount; triangle++)
+        triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned> result;
+    result.reserve(indices.size());
+
+    std::vector<unsigned> cache, nextCache;
+    cache.reserve(LRU_SIZE + 3);
+    nextCache.reserve(LRU_SIZE + 3);
+
+    size_t cursor = 0;
+    long best = static_cast<long>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+
+    while (best >= 0) {
+        emitted[best] = true;
+        const unsigned* corners = &indices[best * 3];
+
+        nextCache.assign(corners, corners + 3);
+        for (const unsigned vertex : cache) {
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+                nextCache.push_back(vertex);
+        }
+
+        for (int corner = 0; corner < 3; corner++) {
+            const unsigned vertex = corners[corner];
+            result.push_back(vertex);
+
+            // drop the emitted triangle from the vertex's list of pending ones
+            unsigned* begin = &adjacency[offsets[vertex]];
+            unsigned* end = begin + remaining[vertex];
+            *std::find(begin, end, static_cast<unsigned>(best)) = *(end - 1);
+            remaining[vertex]--;
+        }
+
+        for (size_t position = 0; position < nextCache.size(); position++) {
+            const unsigned vertex = nextCache[position];
+            cachePositions[vertex] = position < LRU_SIZE ? static_cast<int>(position) : -1;
+            vertexScores[vertex] = cacheScore(cachePositions[vertex], remaining[vertex]);
+        }
+
+        best = -1;
+        float bestScore = -1.0f;
+        for (const unsigned vertex : nextCache) {
+            for (int i = 0; i < remaining[vertex]; i++) {
+                const unsigned triangle = adjacency[offsets[vertex] + i];
+                const unsigned* triangleCorners = &indices[triangle * 3];
+                const float score = vertexScores[triangleCorners[0]] + vertexScores[triangleCorners[1]] + vertexScores[triangleCorners[2]];
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = triangle;
+                }
+            }
+        }
+
+        if (nextCache.size() > LRU_SIZE)
+            nextCache.resize(LRU_SIZE);
+        std::swap(cache, nextCache);
+
+        if (best < 0) {
+            while (cursor < triangleCount && emitted[cursor])
+                cursor++;
+            best = cursor < triangleCount ? static_cast<long>(cursor) : -1;
+        }
+    }
+
+    indices = std::move(result);
+}
+
+// splits the cache ordered triangles into clusters where the cache starts over
+// and draws the clusters facing outwards first, so the inner ones are rejected by the depth test
+void optimizeOverdraw(MeshData& mesh) {
+    const size_t triangleCount = mesh.indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    std::vector<size_t> clusters;
+    std::vector<int> timestamps(mesh.vertices.size(), -FIFO_SIZE - 1);
+    int time = 0;
+
+    for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+        int misses = 0;
+        for (int corner = 0; corner < 3; corner++) {
+            const unsigned vertex = mesh.indices[triangle * 3 + corner];
+            if (time - timestamps[vertex] > FIFO_SIZE) {
+                timestamps[vertex] = time++;
+                misses++;
+            }
+        }
+
+        if (triangle == 0 || misses == 3)
+            clusters.push_back(triangle);
+    }
+    clusters.push_back(triangleCount);
+
+    glm::vec3 meshCentroid(0.0f);
+    for (const auto& vertex : mesh.vertices)
+        meshCentroid += vertex.Position;
+    meshCentroid = meshCentroid / static_cast<float>(mesh.vertices.size());
+
+    struct Cluster {
+        size_t begin, end;
+        float sortKey;
+    };
+
+    std::vector<Cluster> sorted;
+    sorted.reserve(clusters.size() - 1);
+
+    for (size_t i = 0; i + 1 < clusters.size(); i++) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+
+        for (size_t triangle = clusters[i]; triangle < clusters[i + 1]; triangle++) {
+            const glm::vec3& a = mesh.vertices[mesh.indices[triangle * 3]].Position;
+            const glm::vec3& b = mesh.vertices[mesh.indices[triangle * 3 + 1]].Position;
+            const glm::vec3& c = mesh.vertices[mesh.indices[triangle * 3 + 2]].Position;
+
+            const glm::vec3 cross = glm::cross(b - a, c - a);
+            const float weight = glm::length(cross);
+
+            centroid += (a + b + c) * (weight / 3.0f);
+            normal += cross;
+            area += weight;
+        }
+
+        if (area > 0.0f)
+            centroid = centroid / area;
+        const float normalLength = glm::length(normal);
+
+        sorted.push_back(Cluster{
+            clusters[i],
+            clusters[i + 1],
+            normalLength > 0.0f ? glm::dot(centroid - meshCentroid, normal / normalLength) : 0.0f
+        });
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned> result;
+    result.reserve(mesh.indices.size());
+    for (const auto& cluster : sorted)
+        result.insert(result.end(), mesh.indices.begin() + (long) (cluster.begin * 3), mesh.indices.begin() + (long) (cluster.end * 3));
+
+    mesh.indices = std::move(result);
+}
+
+// lays the vertices out in the order the index buffer first references them, unreferenced ones are dropped
+void optimizeVertexFetch(MeshData& mesh) {
+    std::vector<unsigned> remap(mesh.vertices.size(), ~0u);
+    unsigned vertexCount = 0;
+
+    for (const unsigned index : mesh.indices) {
+        if (remap[index] == ~0u)
+            remap[index] = vertexCount++;
+    }
+
+    remapVertices(mesh, remap, vertexCount);
+}
+
+// the plane distance quadric of Garland and Heckbert, stored as the upper triangle of the symmetric 4x4 matrix,
+// weighted by triangle area so the error is a mean squared distance
+struct Quadric {
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, weight;
+
+    void add(const Quadric& other) {
+        a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+        b2 += other.b2; bc += other.bc; bd += other.bd;
+        c2 += other.c2; cd += other.cd;
+        d2 += other.d2;
+        weight += other.weight;
+    }
+
+    double error(const glm::vec3& point) const {
+        const double x = point.x, y = point.y, z = point.z;
+        return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+            + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+            + c2 * z * z + 2 * cd * z
+            + d2;
+    }
+
+    double distance(const glm::vec3& point) const {
+        return weight > 0.0 ? std::sqrt(std::max(error(point), 0.0) / weight) : 0.0;
+    }
+};
+
+static Quadric planeQuadric(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    const glm::vec3 cross = glm::cross(b - a, c - a);
+    const float area = glm::length(cross);
+    if (area == 0.0f) return Quadric{};
+
+    const glm::vec3 normal = cross / area;
+    const double nx = normal.x, ny = normal.y, nz = normal.z, d = -glm::dot(normal, a), weight = area * 0.5;
+    return Quadric{
+        nx * nx * weight, nx * ny * weight, nx * nz * weight, nx * d * weight,
+        ny * ny * weight, ny * nz * weight, ny * d * weight,
+        nz * nz * weight, nz * d * weight,
+        d * d * weight,
+        weight
+    };
+}
+
+static uint64_t edgeKey(unsigned from, unsigned to) {
+    return static_cast<uint64_t>(from) << 32 | to;
+}
+
+// positions on an open border are never moved, so collapses can't pull the outline of the surface inwards
+static std::vector<bool> lockedPositions(const std::vector<unsigned>& indices, const std::vector<unsigned>& positions) {
+    std::vector<bool> locked(positions.size(), false);
+
+    std::unordered_set<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (int corner = 0; corner < 3; corner++)
+            edges.insert(edgeKey(positions[indices[i + corner]], positions[indices[i + (corner + 1) % 3]]));
+    }
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (int corner = 0; corner < 3; corner++) {
+            const unsigned from = positions[indices[i + corner]], to = positions[indices[i + (corner + 1) % 3]];
+            if (!edges.contains(edgeKey(to, from)))
+                locked[from] = locked[to] = true;
+        }
+    }
+
+    return locked;
+}
+
+static bool flips(const std::vector<Vertex>& vertices, const unsigned* triangle, const std::vector<unsigned>& positions, unsigned from, unsigned to) {
+    glm::vec3 before[3], after[3];
+    for (int corner = 0; corner < 3; corner++) {
+        before[corner] = vertices[triangle[corner]].Position;
+        after[corner] = positions[triangle[corner]] == from ? vertices[to].Position : before[corner];
+    }
+
+    const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+    const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+    return glm::dot(normalBefore, normalAfter) <= 0.0f;
+}
+
+// collapses work on positions rather than vertices, the model has hard normals almost everywhere and locking
+// the seams would leave nothing to simplify, so each vertex of the removed position moves to the vertex
+// of the kept position with the closest normal
+std::vector<unsigned> simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned>& source, size_t targetIndexCount, float targetError, float& resultError) {
+    std::vector<unsigned> indices = source;
+    resultError = 0.0f;
+    if (indices.empty() || vertices.empty()) return indices;
+
+    const size_t vertexCount = vertices.size();
+
+    std::unordered_map<VertexKey, unsigned, VertexKeyHash> unique;
+    std::vector<unsigned> positions(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+        const glm::vec3& position = vertices[i].Position;
+        positions[i] = unique.try_emplace(VertexKey{{position.x, position.y, position.z, 0.0f, 0.0f, 0.0f}}, static_cast<unsigned>(i)).first->second;
+    }
+
+    std::vector<unsigned> wedgeOffsets(vertexCount + 1, 0), wedges(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+        wedgeOffsets[positions[i] + 1]++;
+    for (size_t i = 0; i < vertexCount; i++)
+        wedgeOffsets[i + 1] += wedgeOffsets[i];
+    std::vector<unsigned> filledWedges(wedgeOffsets.begin(), wedgeOffsets.end() - 1);
+    for (size_t i = 0; i < vertexCount; i++)
+        wedges[filledWedges[positions[i]]++] = static_cast<unsigned>(i);
+
+    const std::vector<bool> locked = lockedPositions(indices, positions);
+
+    glm::vec3 min = vertices[0].Position, max = min;
+    for (const auto& vertex : vertices) {
+        min = glm::min(min, vertex.Position);
+        max = glm::max(max, vertex.Position);
+    }
+    const double errorLimit = targetError * glm::length(max - min);
+
+    std::vector<Quadric> quadrics(vertexCount, Quadric{});
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const Quadric quadric = planeQuadric(vertices[indices[i]].Position, vertices[indices[i + 1]].Position, vertices[indices[i + 2]].Position);
+        for (int corner = 0; corner < 3; corner++)
+            quadrics[positions[indices[i + corner]]].add(quadric);
+    }
+
+    struct Collapse {
+        unsigned from, to;
+        double error;
+    };
+
+    std::vector<Collapse> collapses;
+    std::vector<unsigned> offsets, adjacency, remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    double maxError = 0.0;
+
+    // every pass collapses the cheapest independent edges, then rebuilds the index buffer
+    while (indices.size() > targetIndexCount) {
+        const size_t triangleCount = indices.size() / 3;
+
+        offsets.assign(vertexCount + 1, 0);
+        for (const unsigned index : indices)
+            offsets[positions[index] + 1]++;
+        for (size_t i = 0; i < vertexCount; i++)
+            offsets[i + 1] += offsets[i];
+
+        adjacency.resize(indices.size());
+        std::vector<unsigned> filled(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacency[filled[positions[indices[i]]]++] = static_cast<unsigned>(i / 3);
+
+        collapses.clear();
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (int corner = 0; corner < 3; corner++) {
+                const unsigned from = positions[indices[i + corner]];
+                if (locked[from]) continue;
+
+                for (const int other : {1, 2}) {
+                    const unsigned to = positions[indices[i + (corner + other) % 3]];
+                    const double error = quadrics[from].distance(vertices[to].Position);
+                    if (error <= errorLimit)
+                        collapses.push_back(Collapse{from, to, error});
+                }
+            }
+        }
+        if (collapses.empty()) break;
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        for (size_t i = 0; i < vertexCount; i++)
+            remap[i] = static_cast<unsigned>(i);
+        touched.assign(vertexCount, false);
+
+        // each collapse removes about two triangles, stop once the pass would overshoot the target
+        const size_t removable = (triangleCount - targetIndexCount / 3) / 2 + 1;
+        size_t collapsed = 0;
+
+        for (const auto& collapse : collapses) {
+            if (collapsed >= removable) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            bool valid = true;
+            for (unsigned k = offsets[collapse.from]; k < offsets[collapse.from + 1] && valid; k++) {
+                const unsigned* triangle = &indices[adjacency[k] * 3];
+                if (positions[triangle[0]] != collapse.to && positions[triangle[1]] != collapse.to && positions[triangle[2]] != collapse.to)
+                    valid = !flips(vertices, triangle, positions, collapse.from, collapse.to);
+            }
+            if (!valid) continue;
+
+            // the one-ring stays untouched for the rest of the pass, so the flip checks above remain accurate
+            for (unsigned k = offsets[collapse.from]; k < offsets[collapse.from + 1]; k++) {
+                const unsigned* triangle = &indices[adjacency[k] * 3];
+                for (int corner = 0; corner < 3; corner++)
+                    touched[positions[triangle[corner]]] = true;
+            }
+
+            for (unsigned k = wedgeOffsets[collapse.from]; k < wedgeOffsets[collapse.from + 1]; k++) {
+                const unsigned vertex = wedges[k];
+                float closest = -2.0f;
+                for (unsigned l = wedgeOffsets[collapse.to]; l < wedgeOffsets[collapse.to + 1]; l++) {
+                    const float similarity = glm::dot(vertices[vertex].Normal, vertices[wedges[l]].Normal);
+                    if (similarity > closest) {
+                        closest = similarity;
+                        remap[vertex] = wedges[l];
+                    }
+                }
+            }
+
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            maxError = std::max(maxError, collapse.error);
+            collapsed++;
+        }
+        if (collapsed == 0) break;
+
+        size_t write = 0;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            const unsigned a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+            if (positions[a] == positions[b] || positions[b] == positions[c] || positions[a] == positions[c]) continue;
+
+            indices[write++] = a;
+            indices[write++] = b;
+            indices[write++] = c;
+        }
+        indices.resize(write);
+    }
+
+    resultError = static_cast<float>(maxError);
+    return indices;
+}
+
+float averageCacheMissRatio(const std::vector<unsigned>& indices, int vertexCount) {
+    if (indices.empty()) return 0.0f;
+
+    std::vector<int> timestamps(vertexCount, -FIFO_SIZE - 1);
+    int time = 0, misses = 0;
+
+    for (const unsigned index : indices) {
+        if (time - timestamps[index] > FIFO_SIZE) {
+            timestamps[index] = time++;
+            misses++;
+        }
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+unsigned packIndices(const MeshData& mesh, std::vector<unsigned char>& packed) {
+    if (mesh.vertices.size() <= 0xffff) {
+        packed.resize(mesh.indices.size() * sizeof(unsigned short));
+        auto narrowed = reinterpret_cast<unsigned short*>(packed.data());
+        for (size_t i = 0; i < mesh.indices.size(); i++)
+            narrowed[i] = static_cast<unsigned short>(mesh.indices[i]);
+        return GL_UNSIGNED_SHORT;
+    }
+
+    packed.resize(mesh.indices.size() * sizeof(unsigned));
+    memcpy(packed.data(), mesh.indices.data(), packed.size());
+    return GL_UNSIGNED_INT;
+}
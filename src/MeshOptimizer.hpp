@@ -0,0 +1,36 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Mesh.hpp"
+#include <vector>
+
+// import time passes over the mesh data, meant to be run in this order before the mesh is uploaded or cached
+
+void weldVertices(MeshData& mesh);
+void optimizeVertexCache(std::vector<unsigned>& indices, size_t vertexCount);
+void optimizeOverdraw(MeshData& mesh);
+void optimizeVertexFetch(MeshData& mesh);
+// quadric error edge collapse towards the target index count, vertices stay where they are so the result shares the vertex buffer,
+// targetError is relative to the mesh extent and the reached error is returned in model units
+std::vector<unsigned> simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned>& source, size_t targetIndexCount, float targetError, float& resultError);
+float averageCacheMissRatio(const std::vector<unsigned>& indices, int vertexCount);
+
+// narrows the indices to 16 bits when the vertex count allows it, returns the GL index type of the packed data
+unsigned packIndices(const MeshData& mesh, std::vector<unsigned char>& packed);
@@ -17,19 +17,90 @@
  */
 
 #include "Model.hpp"
+#include "MeshOptimizer.hpp"
+#include <algorithm>
 #include <cassert>
+#include <limits>
+#include <glm/ext/matrix_transform.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <SDL2/SDL.h>
+
+// relative to the mesh extent
+static const float MAX_LOD_ERROR = 0.05f;
+static const unsigned LOD_REDUCTION = 4;
+
+Model::Model(const std::string& path, MeshArena* arena) : Model(load(path), arena) {}
+
+// only uploads into the arena, everything else has been done by load
+Model::Model(ModelData&& data, MeshArena* arena) : mDecode(1.0f), mBounds(Bounds::empty()) {
+    const VertexLayout& layout = arena->layout();
+    mDirectory = data.path.substr(0, data.path.find_last_of('/'));
+
+    if (data.cache != nullptr) {
+        MeshCache& cache = *data.cache;
+
+        std::vector<std::span<const Vertex>> vertices;
+        for (int i = 0; i < cache.meshCount(); i++)
+            vertices.push_back(cache.vertices(i));
+
+        const glm::mat4 encode = quantize(vertices, layout);
+        for (int i = 0; i < cache.meshCount(); i++)
+            mMeshes.push_back(new Mesh(arena, cache.vertices(i), cache.indices(i), cache.indexType(i), cache.lods(i), encode));
+
+        for (auto mesh : mMeshes)
+            mBounds.merge(mesh->bounds());
+        return;
+    }
+
+    std::vector<std::span<const Vertex>> vertices;
+    for (const auto& mesh : data.meshes)
+        vertices.push_back(mesh.vertices);
+
+    const glm::mat4 encode = quantize(vertices, layout);
+    std::vector<unsigned char> packed;
+    for (const auto& mesh : data.meshes) {
+        const unsigned indexType = packIndices(mesh, packed);
+        mMeshes.push_back(new Mesh(arena, mesh.vertices, packed, indexType, mesh.lods, encode));
+    }
+
+    for (auto mesh : mMeshes)
+        mBounds.merge(mesh->bounds());
+}
+
+// maps the cache or imports, optimizes and caches the source, touches no GL state so it can run on a loader thread
+ModelData Model::load(const std::string& path) {
+    ModelData data{path, {}, std::make_unique<MeshCache>(path)};
+    if (data.cache->valid()) return data;
+    data.cache.reset();
 
-Model::Model(const std::string& path) {
     Assimp::Importer importer;
 
     const aiScene* scene = importer.ReadFile(path.c_str(), aiProcess_Triangulate);
     assert(scene != nullptr && !(scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) && scene->mRootNode != nullptr);
 
-    mDirectory = path.substr(0, path.find_last_of('/'));
+    std::vector<MeshData>& meshes = data.meshes;
+    processNode(scene->mRootNode, scene, meshes);
+
+    for (auto& mesh : meshes) {
+        const float before = averageCacheMissRatio(mesh.indices, (int) mesh.vertices.size());
+        const size_t vertexCount = mesh.vertices.size();
+
+        weldVertices(mesh);
+        optimizeVertexCache(mesh.indices, mesh.vertices.size());
+        optimizeOverdraw(mesh);
+        optimizeVertexFetch(mesh);
 
-    processNode(scene->mRootNode, scene);
+        SDL_Log("%s: %zu -> %zu vertices, ACMR %.3f -> %.3f", path.c_str(), vertexCount, mesh.vertices.size(),
+            before, averageCacheMissRatio(mesh.indices, (int) mesh.vertices.size()));
+
+        generateLods(mesh);
+        for (const auto& lod : mesh.lods)
+            SDL_Log("%s: lod %d, %u triangles, error %g", path.c_str(), (int) (&lod - mesh.lods.data()), lod.indexCount / 3, lod.error);
+    }
+
+    MeshCache::write(path, meshes);
+    return data;
 }
 
 Model::~Model() {
@@ -37,25 +108,99 @@ Model::~Model() {
         delete mesh;
 }
 
-void Model::draw(CompoundShader* shader, const glm::vec4& color) {
+// one packet per mesh, the packet's mesh is filled in here
+void Model::submit(RenderQueue* queue, RenderQueue::Packet packet) {
+    for (auto mesh : mMeshes) {
+        packet.mesh = mesh;
+        queue->submit(packet);
+    }
+}
+
+int Model::lodCount() {
+    int count = 1;
     for (auto mesh : mMeshes)
-        mesh->draw(shader, color);
+        count = std::max(count, mesh->lodCount());
+    return count;
+}
+
+// the coarsest level whose error, in model units, stays within the tolerance
+int Model::selectLod(float tolerance) {
+    for (int lod = lodCount() - 1; lod > 0; lod--) {
+        float error = 0.0f;
+        for (auto mesh : mMeshes)
+            error = std::max(error, mesh->lodError(lod));
+
+        if (error <= tolerance)
+            return lod;
+    }
+    return 0;
+}
+
+// positions are drawn through this matrix, it undoes the quantization of POSITION_SNORM16 and is the identity otherwise
+const glm::mat4& Model::decodeMatrix() {
+    return mDecode;
+}
+
+// in model space, instances are culled with their matrix without the decode matrix
+const Bounds& Model::bounds() {
+    return mBounds;
+}
+
+// fits all meshes into [-1, 1] with a uniform scale, so the normal matrix of a decoded model matrix stays a rotation times a scale
+glm::mat4 Model::quantize(const std::vector<std::span<const Vertex>>& meshes, const VertexLayout& layout) {
+    mDecode = glm::mat4(1.0f);
+    if (layout.position != POSITION_SNORM16) return mDecode;
+
+    glm::vec3 min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max());
+    for (const auto& vertices : meshes) {
+        for (const auto& vertex : vertices) {
+            min = glm::min(min, vertex.Position);
+            max = glm::max(max, vertex.Position);
+        }
+    }
+    if (min.x > max.x) return mDecode;
+
+    const glm::vec3 center = (min + max) * 0.5f, halfExtent = (max - min) * 0.5f;
+    const float extent = std::max(std::max(halfExtent.x, halfExtent.y), std::max(halfExtent.z, 1e-6f));
+
+    mDecode = glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(extent));
+    return glm::inverse(mDecode);
+}
+
+// every level targets a quarter of the previous one's triangles simplifying from the full mesh, the chain ends early
+// once the error bound stops the simplifier from getting meaningfully below the previous level
+void Model::generateLods(MeshData& mesh) {
+    mesh.lods = {Lod{0, (unsigned) mesh.indices.size(), 0.0f}};
+    const std::vector<unsigned> source = mesh.indices;
+
+    while ((int) mesh.lods.size() < Mesh::MAX_LODS) {
+        const unsigned previous = mesh.lods.back().indexCount;
+
+        float error;
+        std::vector<unsigned> indices = simplify(mesh.vertices, source, previous / LOD_REDUCTION / 3 * 3, MAX_LOD_ERROR, error);
+        if (indices.empty() || indices.size() > previous * 3 / 4) break;
+
+        optimizeVertexCache(indices, mesh.vertices.size());
+        mesh.lods.push_back(Lod{(unsigned) mesh.indices.size(), (unsigned) indices.size(), error});
+        mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+    }
 }
 
-void Model::processNode(aiNode* node, const aiScene* scene) {
+void Model::processNode(aiNode* node, const aiScene* scene, std::vector<MeshData>& meshes) {
     for (int i = 0; i < (int) node->mNumMeshes; i++)
-        mMeshes.push_back(processMesh(scene->mMeshes[node->mMeshes[i]]));
+        meshes.push_back(processMesh(scene->mMeshes[node->mMeshes[i]]));
 
     for (int i = 0; i < (int) node->mNumChildren; i++)
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, meshes);
 }
 
-Mesh* Model::processMesh(aiMesh* mesh) {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned> indices;
+MeshData Model::processMesh(aiMesh* mesh) {
+    MeshData data;
+    data.vertices.reserve(mesh->mNumVertices);
+    data.indices.reserve(mesh->mNumFaces * 3);
 
     for (int i = 0; i < (int) mesh->mNumVertices; i++)
-        vertices.push_back(Vertex{
+        data.vertices.push_back(Vertex{
             glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z),
             glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z)
         });
@@ -63,8 +208,8 @@ Mesh* Model::processMesh(aiMesh* mesh) {
     for (int i = 0; i < (int) mesh->mNumFaces; i++) {
         const aiFace face = mesh->mFaces[i];
         for (int j = 0; j < (int) face.mNumIndices; j++)
-            indices.push_back(face.mIndices[j]);
+            data.indices.push_back(face.mIndices[j]);
     }
 
-    return new Mesh(std::move(vertices), std::move(indices));
+    return data;
 }
@@ -19,18 +19,32 @@
 #pragma once
 
 #include "Mesh.hpp"
-#include "CompoundShader.hpp"
+#include "MeshArena.hpp"
+#include "MeshCache.hpp"
+#include "RenderQueue.hpp"
+#include <memory>
+#include <span>
 #include <vector>
 #include <string>
 #include <assimp/scene.h>
 
+// the CPU side of a model, either a mapped cache or freshly imported meshes
+struct ModelData {
+    std::string path;
+    std::vector<MeshData> meshes;
+    std::unique_ptr<MeshCache> cache;
+};
+
 class Model {
 private:
     std::vector<Mesh*> mMeshes;
     std::string mDirectory;
     std::vector<Texture> mLoadedTextures;
+    glm::mat4 mDecode;
+    Bounds mBounds;
 public:
-    explicit Model(const std::string& path);
+    Model(const std::string& path, MeshArena* arena);
+    Model(ModelData&& data, MeshArena* arena);
     Model(const Model&) = delete;
     Model(Model&&) = delete;
 
@@ -39,8 +53,15 @@ public:
     Model& operator =(const Model&) = delete;
     Model& operator =(Model&&) = delete;
 
-    void draw(CompoundShader* shader, const glm::vec4& color);
+    void submit(RenderQueue* queue, RenderQueue::Packet packet);
+    int lodCount();
+    int selectLod(float tolerance);
+    static ModelData load(const std::string& path);
+    const glm::mat4& decodeMatrix();
+    const Bounds& bounds();
 private:
-    void processNode(aiNode* node, const aiScene* scene);
-    Mesh* processMesh(aiMesh* mesh);
+    glm::mat4 quantize(const std::vector<std::span<const Vertex>>& meshes, const VertexLayout& layout);
+    static void generateLods(MeshData& mesh);
+    static void processNode(aiNode* node, const aiScene* scene, std::vector<MeshData>& meshes);
+    static MeshData processMesh(aiMesh* mesh);
 };
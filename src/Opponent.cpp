@@ -0,0 +1,87 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Opponent.hpp"
+#include <utility>
+
+// a single worker so that at most one search runs, the search spreads over its own threads
+Opponent::Opponent(int tableMegabytes, Tablebase* tablebase, std::function<void()> wake) :
+    mSearch(tableMegabytes),
+    mPool(1),
+    mJob(),
+    mMailbox(nullptr),
+    mCancel(false),
+    mTicket(0),
+    mWake(std::move(wake))
+{
+    mSearch.useTablebase(tablebase);
+}
+
+Opponent::~Opponent() {
+    cancel();
+}
+
+void Opponent::think(const Board& board, const SearchLimits& limits) {
+    cancel();
+    mCancel.store(false);
+    const unsigned ticket = ++mTicket;
+
+    mJob = mPool.submit([this, board, limits, ticket]() {
+        const SearchReport report = mSearch.run(board, limits, &mCancel, [this, ticket](const SearchReport& progress) {
+            post(progress, ticket, false);
+        });
+        post(report, ticket, true);
+    });
+}
+
+void Opponent::ponder(const Board& board, int threads) {
+    cancel();
+    mCancel.store(false);
+    ++mTicket;
+
+    mJob = mPool.submit([this, board, threads]() {
+        mSearch.run(board, SearchLimits{Search::MAX_PLY - 1, 0, threads}, &mCancel);
+    });
+}
+
+// the ticket moves on so a report posted between the flag and the wait is recognized as stale
+void Opponent::cancel() {
+    mCancel.store(true);
+    ++mTicket;
+    if (mJob.valid())
+        mJob.wait();
+
+    delete mMailbox.exchange(nullptr);
+}
+
+bool Opponent::poll(SearchReport& report, bool& final) {
+    Letter* letter = mMailbox.exchange(nullptr);
+    if (letter == nullptr) return false;
+
+    const bool current = letter->ticket == mTicket;
+    report = letter->report;
+    final = letter->final;
+    delete letter;
+    return current;
+}
+
+// a newer report replaces one that wasn't taken yet, only the newest one matters
+void Opponent::post(const SearchReport& report, unsigned ticket, bool final) {
+    delete mMailbox.exchange(new Letter{report, ticket, final});
+    mWake();
+}
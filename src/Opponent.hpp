@@ -0,0 +1,69 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ThreadPool.hpp"
+#include "engine/Board.hpp"
+#include "engine/Search.hpp"
+#include "engine/Tablebase.hpp"
+#include <atomic>
+#include <functional>
+#include <future>
+
+// runs the computer's searches as jobs off the render thread, which polls for their reports once a frame
+class Opponent final {
+private:
+    // a report of the search started under the ticket, handed over in a single slot
+    struct Letter {
+        SearchReport report;
+        unsigned ticket;
+        bool final;
+    };
+
+    Search mSearch;
+    ThreadPool mPool;
+    std::future<void> mJob;
+    std::atomic<Letter*> mMailbox;
+    std::atomic<bool> mCancel;
+    unsigned mTicket;
+    std::function<void()> mWake;
+public:
+    // wake is called on the search thread after every report so a sleeping render loop can pick it up,
+    // the tablebase may be nullptr and is left to the caller to delete
+    Opponent(int tableMegabytes, Tablebase* tablebase, std::function<void()> wake);
+    Opponent(const Opponent&) = delete;
+    Opponent(Opponent&&) = delete;
+
+    ~Opponent();
+
+    Opponent& operator =(const Opponent&) = delete;
+    Opponent& operator =(Opponent&&) = delete;
+
+    // searches for the move to play from the position, cancelling whatever ran before
+    void think(const Board& board, const SearchLimits& limits);
+    // searches the position the player is thinking over without a limit and without reports,
+    // the table it fills makes the search for the reply start ahead
+    void ponder(const Board& board, int threads);
+    // returns once the running search, if any, has stopped, its reports are dropped
+    void cancel();
+    // takes the newest report of the current search if there's one not taken yet, final marks the last one
+    bool poll(SearchReport& report, bool& final);
+private:
+    void post(const SearchReport& report, unsigned ticket, bool final);
+};
@@ -0,0 +1,160 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "OutlinePass.hpp"
+#include "GlState.hpp"
+#include "Stats.hpp"
+#include <cassert>
+#include <GL/glew.h>
+
+static const char* const FULLSCREEN_VERTEX = "shaders/fullscreenVertex.glsl";
+
+static unsigned createTexture(int width, int height, int internalFormat, unsigned format, unsigned type) {
+    unsigned texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+static unsigned createFramebuffer(unsigned texture) {
+    unsigned framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    return framebuffer;
+}
+
+OutlinePass::OutlinePass() :
+    mSeedShader(new CompoundShader(FULLSCREEN_VERTEX, "shaders/outlineSeedFragment.glsl")),
+    mFloodShader(new CompoundShader(FULLSCREEN_VERTEX, "shaders/outlineFloodFragment.glsl")),
+    mCompositeShader(new CompoundShader(FULLSCREEN_VERTEX, "shaders/outlineCompositeFragment.glsl")),
+    mSeedMask(mSeedShader->uniform<int>("mask")),
+    mFloodSeeds(mFloodShader->uniform<int>("seeds")),
+    mFloodStep(mFloodShader->uniform<int>("step")),
+    mCompositeMask(mCompositeShader->uniform<int>("mask")),
+    mCompositeSeeds(mCompositeShader->uniform<int>("seeds")),
+    mCompositeWidth(mCompositeShader->uniform<float>("width")),
+    mVao(0),
+    mMaskFbo(0),
+    mMaskTexture(0),
+    mSeedFbos(),
+    mSeedTextures(),
+    mWidth(0),
+    mHeight(0)
+{
+    // the core profile doesn't draw without a vertex array, even when no attributes are read
+    glGenVertexArrays(1, &mVao);
+}
+
+OutlinePass::~OutlinePass() {
+    release();
+    gGlState.deleteVertexArray(mVao);
+
+    delete mSeedShader;
+    delete mFloodShader;
+    delete mCompositeShader;
+}
+
+// binds the mask cleared to nothing, the outlined objects are drawn into it with their outline color and no depth test
+void OutlinePass::beginMask(int width, int height) {
+    if (width != mWidth || height != mHeight)
+        resize(width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, mMaskFbo);
+    glViewport(0, 0, mWidth, mHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+// steps of halving lengths, starting from the largest power of two within the width, reach every seed up to twice that away
+void OutlinePass::composite(unsigned targetFramebuffer, float outlineWidth) {
+    gGlState.setDepthTest(false);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, mMaskTexture);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, mSeedFbos[0]);
+    mSeedShader->use();
+    mSeedShader->setValue(mSeedMask, 1);
+    drawFullscreen();
+
+    int step = 1, current = 0;
+    while (static_cast<float>(step * 2) <= outlineWidth + 0.5f)
+        step *= 2;
+
+    mFloodShader->use();
+    mFloodShader->setValue(mFloodSeeds, 2);
+    for (; step >= 1; step /= 2, current = 1 - current) {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, mSeedTextures[current]);
+        glBindFramebuffer(GL_FRAMEBUFFER, mSeedFbos[1 - current]);
+
+        mFloodShader->setValue(mFloodStep, step);
+        drawFullscreen();
+    }
+
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, mSeedTextures[current]);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+
+    mCompositeShader->use();
+    mCompositeShader->setValue(mCompositeMask, 1);
+    mCompositeShader->setValue(mCompositeSeeds, 2);
+    mCompositeShader->setValue(mCompositeWidth, outlineWidth);
+    drawFullscreen();
+
+    glActiveTexture(GL_TEXTURE0);
+    gGlState.setDepthTest(true);
+}
+
+// the seeds are pixel coordinates, 16 bits are exact where half floats wouldn't be
+void OutlinePass::resize(int width, int height) {
+    release();
+    mWidth = width;
+    mHeight = height;
+
+    mMaskTexture = createTexture(width, height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    mMaskFbo = createFramebuffer(mMaskTexture);
+
+    for (int i = 0; i < 2; i++) {
+        mSeedTextures[i] = createTexture(width, height, GL_RG16UI, GL_RG_INTEGER, GL_UNSIGNED_SHORT);
+        mSeedFbos[i] = createFramebuffer(mSeedTextures[i]);
+    }
+}
+
+void OutlinePass::release() {
+    if (mMaskFbo == 0) return;
+
+    glDeleteFramebuffers(1, &mMaskFbo);
+    glDeleteTextures(1, &mMaskTexture);
+    glDeleteFramebuffers(2, mSeedFbos);
+    glDeleteTextures(2, mSeedTextures);
+    mMaskFbo = 0;
+}
+
+void OutlinePass::drawFullscreen() {
+    gGlState.bindVertexArray(mVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    gStats.count(Stats::DRAW_CALLS);
+}
@@ -0,0 +1,48 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "CompoundShader.hpp"
+
+// draws outlines of a constant width in pixels around whatever has been drawn into its mask, in the color it was drawn with,
+// the mask is spread out by jump flooding so the cost depends on the width and the resolution only
+class OutlinePass final {
+private:
+    CompoundShader* mSeedShader, * mFloodShader, * mCompositeShader;
+    Uniform<int> mSeedMask, mFloodSeeds, mFloodStep, mCompositeMask, mCompositeSeeds;
+    Uniform<float> mCompositeWidth;
+    unsigned mVao, mMaskFbo, mMaskTexture, mSeedFbos[2], mSeedTextures[2];
+    int mWidth, mHeight;
+public:
+    OutlinePass();
+    OutlinePass(const OutlinePass&) = delete;
+    OutlinePass(OutlinePass&&) = delete;
+
+    ~OutlinePass();
+
+    OutlinePass& operator =(const OutlinePass&) = delete;
+    OutlinePass& operator =(OutlinePass&&) = delete;
+
+    void beginMask(int width, int height);
+    void composite(unsigned targetFramebuffer, float outlineWidth);
+private:
+    void resize(int width, int height);
+    void release();
+    void drawFullscreen();
+};
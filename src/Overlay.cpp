@@ -0,0 +1,158 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Overlay.hpp"
+#include "GlState.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <GL/glew.h>
+
+static const char GLYPHS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:-/%() ";
+static const int GLYPH_COUNT = sizeof GLYPHS; // the terminator's slot is a solid block used for the background
+static const int GLYPH_WIDTH = 3, GLYPH_HEIGHT = 5, SCALE = 3, PADDING = 8;
+
+// five rows of three bits each, the topmost row in the highest bits
+static const unsigned short FONT[GLYPH_COUNT] = {
+    075557, 026227, 071747, 071717, 055711, 074717, 074757, 071111, 075757, 075717,
+    025755, 065656, 034443, 065556, 074647, 074644, 034553, 055755, 072227, 011152,
+    055655, 044447, 057755, 065555, 025552, 065644, 025563, 065655, 034216, 072222,
+    055557, 055552, 055775, 055255, 055222, 071247, 000002, 002020, 000700, 011244,
+    051245, 024442, 021112, 000000, 077777
+};
+
+Overlay::Overlay() :
+    mShader(new CompoundShader("shaders/overlayVertex.glsl", "shaders/overlayFragment.glsl")),
+    mScreenSize(mShader->uniform<glm::vec2>("screenSize")),
+    mFont(mShader->uniform<int>("font")),
+    mVao(0),
+    mVbo(0),
+    mTexture(0),
+    mVertices()
+{
+    unsigned char pixels[GLYPH_HEIGHT][GLYPH_COUNT * GLYPH_WIDTH];
+    for (int glyph = 0; glyph < GLYPH_COUNT; glyph++) {
+        for (int row = 0; row < GLYPH_HEIGHT; row++) {
+            for (int column = 0; column < GLYPH_WIDTH; column++) {
+                const int bit = (GLYPH_HEIGHT - 1 - row) * GLYPH_WIDTH + (GLYPH_WIDTH - 1 - column);
+                pixels[row][glyph * GLYPH_WIDTH + column] = FONT[glyph] >> bit & 1 ? 0xff : 0;
+            }
+        }
+    }
+
+    glGenTextures(1, &mTexture);
+    glBindTexture(GL_TEXTURE_2D, mTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, GLYPH_COUNT * GLYPH_WIDTH, GLYPH_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenVertexArrays(1, &mVao);
+    glGenBuffers(1, &mVbo);
+
+    gGlState.bindVertexArray(mVao);
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), reinterpret_cast<void*>(offsetof(OverlayVertex, Position)));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), reinterpret_cast<void*>(offsetof(OverlayVertex, TexCoords)));
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), reinterpret_cast<void*>(offsetof(OverlayVertex, Color)));
+
+    gGlState.bindVertexArray(0);
+}
+
+Overlay::~Overlay() {
+    delete mShader;
+    gGlState.deleteVertexArray(mVao);
+    glDeleteBuffers(1, &mVbo);
+    glDeleteTextures(1, &mTexture);
+}
+
+void Overlay::draw(const std::vector<std::string>& lines, int width, int height) {
+    const float advance = (GLYPH_WIDTH + 1) * SCALE, lineHeight = (GLYPH_HEIGHT + 2) * SCALE;
+
+    size_t columns = 0;
+    for (const auto& line : lines)
+        columns = std::max(columns, line.size());
+
+    mVertices.clear();
+    addGlyph(
+        GLYPH_COUNT - 1,
+        0.0f,
+        0.0f,
+        static_cast<float>(columns) * advance + 2 * PADDING,
+        static_cast<float>(lines.size()) * lineHeight + 2 * PADDING - 2 * SCALE,
+        glm::vec4(0.0f, 0.0f, 0.0f, 0.6f)
+    );
+
+    for (size_t row = 0; row < lines.size(); row++) {
+        for (size_t column = 0; column < lines[row].size(); column++) {
+            const char* found = strchr(GLYPHS, toupper(static_cast<unsigned char>(lines[row][column])));
+            if (found == nullptr || *found == ' ' || *found == 0) continue;
+
+            addGlyph(
+                static_cast<int>(found - GLYPHS),
+                PADDING + static_cast<float>(column) * advance,
+                PADDING + static_cast<float>(row) * lineHeight,
+                GLYPH_WIDTH * SCALE,
+                GLYPH_HEIGHT * SCALE,
+                glm::vec4(1.0f)
+            );
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+    glBufferData(GL_ARRAY_BUFFER, (long) (mVertices.size() * sizeof(OverlayVertex)), mVertices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    gGlState.setDepthTest(false);
+    glDisable(GL_CULL_FACE);
+
+    mShader->use();
+    mShader->setValue(mScreenSize, glm::vec2(static_cast<float>(width), static_cast<float>(height)));
+    mShader->setValue(mFont, 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, mTexture);
+
+    gGlState.bindVertexArray(mVao);
+    glDrawArrays(GL_TRIANGLES, 0, (int) mVertices.size());
+
+    gGlState.setDepthTest(true);
+    glEnable(GL_CULL_FACE);
+}
+
+void Overlay::addGlyph(int glyph, float x, float y, float width, float height, const glm::vec4& color) {
+    const float left = static_cast<float>(glyph * GLYPH_WIDTH) / (GLYPH_COUNT * GLYPH_WIDTH);
+    const float right = static_cast<float>((glyph + 1) * GLYPH_WIDTH) / (GLYPH_COUNT * GLYPH_WIDTH);
+
+    const OverlayVertex topLeft{glm::vec2(x, y), glm::vec2(left, 0.0f), color};
+    const OverlayVertex topRight{glm::vec2(x + width, y), glm::vec2(right, 0.0f), color};
+    const OverlayVertex bottomLeft{glm::vec2(x, y + height), glm::vec2(left, 1.0f), color};
+    const OverlayVertex bottomRight{glm::vec2(x + width, y + height), glm::vec2(right, 1.0f), color};
+
+    mVertices.insert(mVertices.end(), {topLeft, bottomLeft, bottomRight, topLeft, bottomRight, topRight});
+}
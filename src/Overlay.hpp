@@ -0,0 +1,52 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "CompoundShader.hpp"
+#include <string>
+#include <vector>
+
+// draws lines of text in the top left corner of the screen with a built-in 3x5 pixel font
+class Overlay final {
+private:
+    struct OverlayVertex {
+        glm::vec2 Position;
+        glm::vec2 TexCoords;
+        glm::vec4 Color;
+    };
+
+    CompoundShader* mShader;
+    Uniform<glm::vec2> mScreenSize;
+    Uniform<int> mFont;
+    unsigned mVao, mVbo, mTexture;
+    std::vector<OverlayVertex> mVertices;
+public:
+    Overlay();
+    Overlay(const Overlay&) = delete;
+    Overlay(Overlay&&) = delete;
+
+    ~Overlay();
+
+    Overlay& operator =(const Overlay&) = delete;
+    Overlay& operator =(Overlay&&) = delete;
+
+    void draw(const std::vector<std::string>& lines, int width, int height);
+private:
+    void addGlyph(int glyph, float x, float y, float width, float height, const glm::vec4& color);
+};
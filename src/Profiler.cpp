@@ -0,0 +1,200 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Profiler.hpp"
+#include <cstdio>
+#include <ctime>
+#include <SDL2/SDL.h>
+#include <GL/glew.h>
+
+Profiler::Profiler() :
+    mQueries(),
+    mIssued(),
+    mCurrent(0),
+    mCpuStart(),
+    mFrameStart(std::chrono::steady_clock::now()),
+    mPending(),
+    mHistory(),
+    mHistoryHead(0),
+    mHistorySize(0)
+{
+    glGenQueries(PASS_COUNT, mQueries[0]);
+    glGenQueries(PASS_COUNT, mQueries[1]);
+}
+
+Profiler::~Profiler() {
+    glDeleteQueries(PASS_COUNT, mQueries[0]);
+    glDeleteQueries(PASS_COUNT, mQueries[1]);
+}
+
+void Profiler::begin(Pass pass) {
+    mCpuStart[pass] = std::chrono::steady_clock::now();
+    glBeginQuery(GL_TIME_ELAPSED, mQueries[mCurrent][pass]);
+}
+
+void Profiler::end(Pass pass) {
+    glEndQuery(GL_TIME_ELAPSED);
+    mIssued[mCurrent][pass] = true;
+    mPending.cpuTimes[pass] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - mCpuStart[pass]).count();
+}
+
+// GPU times lag one frame behind, a result that still isn't available is dropped instead of stalling the pipeline
+void Profiler::endFrame() {
+    const auto now = std::chrono::steady_clock::now();
+    mPending.frameTime = std::chrono::duration<float, std::milli>(now - mFrameStart).count();
+    mFrameStart = now;
+
+    const int previous = 1 - mCurrent;
+    for (int pass = 0; pass < PASS_COUNT; pass++) {
+        mPending.gpuTimes[pass] = 0.0f;
+        if (!mIssued[previous][pass]) continue;
+        mIssued[previous][pass] = false;
+
+        int available = GL_FALSE;
+        glGetQueryObjectiv(mQueries[previous][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) continue;
+
+        GLuint64 elapsed;
+        glGetQueryObjectui64v(mQueries[previous][pass], GL_QUERY_RESULT, &elapsed);
+        mPending.gpuTimes[pass] = static_cast<float>(elapsed) / 1e6f;
+    }
+    mCurrent = previous;
+
+    for (int counter = 0; counter < Stats::COUNTER_COUNT; counter++) {
+        mPending.counters[counter] = gStats.counters[counter];
+        gStats.counters[counter] = 0;
+    }
+
+    mHistory[mHistoryHead] = mPending;
+    mHistoryHead = (mHistoryHead + 1) % HISTORY;
+    if (mHistorySize < HISTORY)
+        mHistorySize++;
+
+    mPending = Sample();
+}
+
+float Profiler::cpuTime(Pass pass) {
+    return latest().cpuTimes[pass];
+}
+
+float Profiler::gpuTime(Pass pass) {
+    return latest().gpuTimes[pass];
+}
+
+float Profiler::frameTime() {
+    return latest().frameTime;
+}
+
+unsigned long Profiler::counter(Stats::Counter counter) {
+    return latest().counters[counter];
+}
+
+float Profiler::averageCpuTime(Pass pass) {
+    float total = 0.0f;
+    for (int i = 0; i < mHistorySize; i++)
+        total += mHistory[i].cpuTimes[pass];
+    return mHistorySize == 0 ? 0.0f : total / static_cast<float>(mHistorySize);
+}
+
+float Profiler::averageGpuTime(Pass pass) {
+    float total = 0.0f;
+    for (int i = 0; i < mHistorySize; i++)
+        total += mHistory[i].gpuTimes[pass];
+    return mHistorySize == 0 ? 0.0f : total / static_cast<float>(mHistorySize);
+}
+
+float Profiler::averageFrameTime() {
+    float total = 0.0f;
+    for (int i = 0; i < mHistorySize; i++)
+        total += mHistory[i].frameTime;
+    return mHistorySize == 0 ? 0.0f : total / static_cast<float>(mHistorySize);
+}
+
+float Profiler::averageCounter(Stats::Counter counter) {
+    double total = 0.0;
+    for (int i = 0; i < mHistorySize; i++)
+        total += static_cast<double>(mHistory[i].counters[counter]);
+    return mHistorySize == 0 ? 0.0f : static_cast<float>(total / mHistorySize);
+}
+
+// appends a human readable snapshot of the whole history so a single capture is enough to diagnose a slow machine
+bool Profiler::writeCapture(const std::string& path, const std::string& header) {
+    std::string capture;
+    char line[256];
+
+    const time_t now = time(nullptr);
+    strftime(line, sizeof line, "=== capture %Y-%m-%d %H:%M:%S ===\n", localtime(&now));
+    capture += line;
+    capture += header;
+
+    snprintf(line, sizeof line, "frames averaged: %d, frame time: %.3f ms average, %.3f ms last\n", mHistorySize, averageFrameTime(), frameTime());
+    capture += line;
+
+    for (int pass = 0; pass < PASS_COUNT; pass++) {
+        snprintf(
+            line,
+            sizeof line,
+            "%-8s cpu %.3f ms  gpu %.3f ms  (last cpu %.3f ms, gpu %.3f ms)\n",
+            passName(static_cast<Pass>(pass)),
+            averageCpuTime(static_cast<Pass>(pass)),
+            averageGpuTime(static_cast<Pass>(pass)),
+            cpuTime(static_cast<Pass>(pass)),
+            gpuTime(static_cast<Pass>(pass))
+        );
+        capture += line;
+    }
+
+    for (int i = 0; i < Stats::COUNTER_COUNT; i++) {
+        snprintf(
+            line,
+            sizeof line,
+            "%-16s %.1f average, %lu last\n",
+            Stats::counterName(static_cast<Stats::Counter>(i)),
+            averageCounter(static_cast<Stats::Counter>(i)),
+            counter(static_cast<Stats::Counter>(i))
+        );
+        capture += line;
+    }
+    capture += '\n';
+
+    SDL_RWops* file = SDL_RWFromFile(path.c_str(), "a");
+    if (file == nullptr) return false;
+
+    const bool written = SDL_RWwrite(file, capture.data(), 1, capture.size()) == capture.size();
+    SDL_RWclose(file);
+    return written;
+}
+
+const char* Profiler::passName(Pass pass) {
+    switch (pass) {
+        case SHADOW:
+            return "shadow";
+        case SCENE:
+            return "scene";
+        case OUTLINE:
+            return "outline";
+        case LIGHT:
+            return "light";
+        default:
+            return "";
+    }
+}
+
+const Profiler::Sample& Profiler::latest() {
+    return mHistory[(mHistoryHead + HISTORY - 1) % HISTORY];
+}
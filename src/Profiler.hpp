@@ -0,0 +1,75 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Stats.hpp"
+#include <chrono>
+#include <string>
+
+class Profiler final {
+public:
+    enum Pass {
+        SHADOW,
+        SCENE,
+        OUTLINE,
+        LIGHT,
+        PASS_COUNT
+    };
+
+    static const int HISTORY = 120;
+private:
+    struct Sample {
+        float cpuTimes[PASS_COUNT], gpuTimes[PASS_COUNT];
+        float frameTime;
+        unsigned long counters[Stats::COUNTER_COUNT];
+    };
+
+    // two sets of queries, the results of the previous frame are read while the current one is being recorded
+    unsigned mQueries[2][PASS_COUNT];
+    bool mIssued[2][PASS_COUNT];
+    int mCurrent;
+    std::chrono::steady_clock::time_point mCpuStart[PASS_COUNT], mFrameStart;
+    Sample mPending, mHistory[HISTORY];
+    int mHistoryHead, mHistorySize;
+public:
+    Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler(Profiler&&) = delete;
+
+    ~Profiler();
+
+    Profiler& operator =(const Profiler&) = delete;
+    Profiler& operator =(Profiler&&) = delete;
+
+    void begin(Pass pass);
+    void end(Pass pass);
+    void endFrame();
+    float cpuTime(Pass pass);
+    float gpuTime(Pass pass);
+    float frameTime();
+    unsigned long counter(Stats::Counter counter);
+    float averageCpuTime(Pass pass);
+    float averageGpuTime(Pass pass);
+    float averageFrameTime();
+    float averageCounter(Stats::Counter counter);
+    bool writeCapture(const std::string& path, const std::string& header);
+    static const char* passName(Pass pass);
+private:
+    const Sample& latest();
+};
@@ -0,0 +1,156 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ProgramCache.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <GL/glew.h>
+
+static const char MAGIC[4] = {'J', 'P', 'R', 'G'};
+static const uint32_t VERSION = 1;
+
+static uint64_t hash(uint64_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    // separates the fields so moving text from one to the next changes the key
+    return (hash ^ 0xff) * 1099511628211ull;
+}
+
+static uint64_t hash(uint64_t value, unsigned name) {
+    const char* string = reinterpret_cast<const char*>(glGetString(name));
+    return string == nullptr ? hash(value, "", 0) : hash(value, string, strlen(string));
+}
+
+static std::string cachePath(const std::string& directory, uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof name, "%016llx.bin", static_cast<unsigned long long>(key));
+    return directory + "/" + name;
+}
+
+// returns 0 when there's no usable binary, the caller then links from the sources
+unsigned ProgramCache::load(const ShaderSources& sources) {
+    if (!supported()) return 0;
+
+    const uint64_t programKey = key(sources);
+    const int file = open(cachePath(directory(), programKey).c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) return 0;
+
+    Header header;
+    std::vector<unsigned char> binary;
+
+    bool valid = read(file, &header, sizeof header) == sizeof header
+        && memcmp(header.magic, MAGIC, sizeof MAGIC) == 0
+        && header.version == VERSION
+        && header.key == programKey;
+
+    if (valid) {
+        binary.resize(header.length);
+        valid = read(file, binary.data(), binary.size()) == static_cast<ssize_t>(binary.size());
+    }
+    close(file);
+    if (!valid) return 0;
+
+    // drivers reject binaries from other builds at this point even when the version string didn't change
+    const unsigned program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), static_cast<int>(binary.size()));
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (success != GL_TRUE) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// the program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+void ProgramCache::store(const ShaderSources& sources, unsigned program) {
+    if (!supported()) return;
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof MAGIC);
+    header.version = VERSION;
+    header.key = key(sources);
+
+    std::vector<unsigned char> binary(length);
+    GLenum format;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    header.format = format;
+    header.length = static_cast<uint32_t>(length);
+
+    const std::string cacheDirectory = directory();
+    if (cacheDirectory.empty()) return;
+
+    // written to a temporary file first so a concurrently starting instance never reads half a binary
+    const std::string path = cachePath(cacheDirectory, header.key), temporaryPath = path + "." + std::to_string(getpid());
+
+    const int file = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file < 0) return;
+
+    const bool written = write(file, &header, sizeof header) == sizeof header
+        && write(file, binary.data(), header.length) == static_cast<ssize_t>(header.length);
+    close(file);
+
+    if (!written || rename(temporaryPath.c_str(), path.c_str()) != 0)
+        unlink(temporaryPath.c_str());
+}
+
+bool ProgramCache::supported() {
+    if (!GLEW_ARB_get_program_binary) return false;
+
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+uint64_t ProgramCache::key(const ShaderSources& sources) {
+    uint64_t value = 14695981039346656037ull;
+    value = hash(value, sources.vertex.data(), sources.vertex.size());
+    value = hash(value, sources.fragment.data(), sources.fragment.size());
+    value = hash(value, GL_VENDOR);
+    value = hash(value, GL_RENDERER);
+    value = hash(value, GL_VERSION);
+    return hash(value, GL_SHADING_LANGUAGE_VERSION);
+}
+
+// created on first use, empty when there's neither XDG_CACHE_HOME nor HOME
+std::string ProgramCache::directory() {
+    std::string base;
+    if (const char* cacheHome = getenv("XDG_CACHE_HOME"); cacheHome != nullptr && *cacheHome != 0)
+        base = cacheHome;
+    else if (const char* home = getenv("HOME"); home != nullptr && *home != 0)
+        base = std::string(home) + "/.cache";
+    else
+        return "";
+
+    mkdir(base.c_str(), 0755);
+    const std::string path = base + "/jealno";
+    mkdir(path.c_str(), 0755);
+    return path;
+}
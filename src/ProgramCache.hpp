@@ -0,0 +1,45 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "CompoundShader.hpp"
+#include <cstdint>
+#include <string>
+
+// linked program binaries stored under $XDG_CACHE_HOME/jealno, one file per program named after a hash of its sources and
+// of the driver's vendor, renderer and version strings, so any change to those simply misses and the program is linked again
+class ProgramCache final {
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t length;
+    };
+public:
+    ProgramCache() = delete;
+
+    static unsigned load(const ShaderSources& sources);
+    static void store(const ShaderSources& sources, unsigned program);
+    static bool supported();
+private:
+    static uint64_t key(const ShaderSources& sources);
+    static std::string directory();
+};
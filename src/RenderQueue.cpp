@@ -0,0 +1,90 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RenderQueue.hpp"
+#include "GlState.hpp"
+#include <algorithm>
+
+// pass, state, program, vertex array and the submission order from the highest bits down,
+// the order keeps draws that compare equal otherwise in the order they came in
+void RenderQueue::submit(const Packet& packet) {
+    if (packet.instances != nullptr && packet.count == 0) return;
+
+    const uint64_t key =
+        static_cast<uint64_t>(packet.pass & 0xff) << 56 |
+        static_cast<uint64_t>(packet.state & 0xff) << 48 |
+        static_cast<uint64_t>(packet.shader->program() & 0xffff) << 32 |
+        static_cast<uint64_t>(packet.mesh->arena()->vertexArray() & 0xffff) << 16 |
+        static_cast<uint64_t>(mEntries.size() & 0xffff);
+
+    mEntries.push_back(Entry{key, packet});
+}
+
+void RenderQueue::flush() {
+    std::sort(mEntries.begin(), mEntries.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+
+    for (size_t i = 0; i < mEntries.size();) {
+        const Packet& packet = mEntries[i].packet;
+        apply(packet.state);
+        packet.shader->use();
+
+        if (packet.instances == nullptr) {
+            packet.shader->setValue(packet.modelUniform, packet.model);
+            packet.shader->setValue(packet.colorUniform, packet.color);
+            packet.mesh->draw(packet.lod);
+            i++;
+            continue;
+        }
+
+        if (!packet.mesh->arena()->multiDrawSupported()) {
+            packet.mesh->drawInstanced(packet.instances, packet.lod, packet.first, packet.count);
+            i++;
+            continue;
+        }
+
+        // the following packets that differ only in the mesh, the level and the instance range go out in one call
+        mCommands.clear();
+        for (; i < mEntries.size() && batchable(packet, mEntries[i].packet); i++) {
+            const Packet& next = mEntries[i].packet;
+            mCommands.push_back(next.mesh->command(next.lod, next.first, next.count));
+        }
+        packet.mesh->arena()->multiDraw(packet.instances, packet.mesh->indexType(), mCommands);
+    }
+
+    mEntries.clear();
+}
+
+bool RenderQueue::batchable(const Packet& first, const Packet& next) {
+    return next.pass == first.pass
+        && next.state == first.state
+        && next.shader == first.shader
+        && next.instances == first.instances
+        && next.mesh->arena() == first.mesh->arena()
+        && next.mesh->indexType() == first.mesh->indexType();
+}
+
+void RenderQueue::apply(State state) {
+    switch (state) {
+        case OPAQUE:
+            gGlState.setDepthTest(true);
+            break;
+        case UNTESTED:
+            gGlState.setDepthTest(false);
+            break;
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "CompoundShader.hpp"
+#include "InstanceBuffer.hpp"
+#include "Mesh.hpp"
+#include "MeshArena.hpp"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// collects the draws of a frame and replays them sorted by pass, fixed function state, program and vertex array,
+// so the state cache sees as few changes as possible
+class RenderQueue final {
+public:
+    enum Pass {
+        SHADOW,
+        SCENE,
+        OUTLINE,
+        LIGHT
+    };
+
+    // the fixed function setups a draw can ask for, in the order they're replayed within a pass
+    enum State {
+        OPAQUE, // depth tested
+        UNTESTED // drawn over whatever is there
+    };
+
+    // a draw of one mesh, either of a range of instances or a single one placed with the model and color uniforms
+    struct Packet {
+        Pass pass;
+        State state;
+        CompoundShader* shader;
+        Mesh* mesh;
+        int lod;
+        InstanceBuffer* instances;
+        int first, count;
+        Uniform<glm::mat4> modelUniform;
+        glm::mat4 model;
+        Uniform<glm::vec3> colorUniform;
+        glm::vec3 color;
+    };
+private:
+    struct Entry {
+        uint64_t key;
+        Packet packet;
+    };
+
+    std::vector<Entry> mEntries;
+    std::vector<DrawCommand> mCommands;
+public:
+    RenderQueue() = default;
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue(RenderQueue&&) = delete;
+
+    RenderQueue& operator =(const RenderQueue&) = delete;
+    RenderQueue& operator =(RenderQueue&&) = delete;
+
+    void submit(const Packet& packet);
+    void flush();
+private:
+    static void apply(State state);
+    static bool batchable(const Packet& first, const Packet& next);
+};
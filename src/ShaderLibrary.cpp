@@ -0,0 +1,73 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ShaderLibrary.hpp"
+#include <algorithm>
+
+ShaderLibrary::ShaderLibrary() : mSources(), mVariants(), mUniformBlocks() {}
+
+ShaderLibrary::~ShaderLibrary() {
+    for (auto& [key, shader] : mVariants)
+        delete shader;
+}
+
+// takes a source that has been read and expanded ahead of time, see CompoundShader::readSource
+void ShaderLibrary::addSource(const std::string& path, std::string source) {
+    mSources[path] = std::move(source);
+}
+
+// applied to the variants compiled so far and to every later one
+void ShaderLibrary::bindUniformBlock(const std::string& name, unsigned binding) {
+    mUniformBlocks.emplace_back(name, binding);
+    for (auto& [key, shader] : mVariants)
+        shader->bindUniformBlock(name.c_str(), binding);
+}
+
+CompoundShader* ShaderLibrary::variant(const std::string& vertexPath, const std::string& fragmentPath, std::vector<std::string> defines) {
+    std::sort(defines.begin(), defines.end());
+    defines.erase(std::unique(defines.begin(), defines.end()), defines.end());
+
+    std::string key = vertexPath + '\n' + fragmentPath;
+    for (const auto& define : defines)
+        key += '\n' + define;
+
+    if (const auto found = mVariants.find(key); found != mVariants.end())
+        return found->second;
+
+    const auto shader = new CompoundShader(ShaderSources{
+        CompoundShader::withDefines(source(vertexPath), defines),
+        CompoundShader::withDefines(source(fragmentPath), defines)
+    });
+    for (const auto& [name, binding] : mUniformBlocks)
+        shader->bindUniformBlock(name.c_str(), binding);
+
+    mVariants.emplace(std::move(key), shader);
+    return shader;
+}
+
+int ShaderLibrary::variantCount() {
+    return (int) mVariants.size();
+}
+
+// sources that weren't added up front are read on first use
+const std::string& ShaderLibrary::source(const std::string& path) {
+    auto found = mSources.find(path);
+    if (found == mSources.end())
+        found = mSources.emplace(path, CompoundShader::readSource(path)).first;
+    return found->second;
+}
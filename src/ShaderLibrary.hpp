@@ -0,0 +1,50 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "CompoundShader.hpp"
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// specialized variants of shared sources, a variant is compiled the first time it's asked for and the same
+// sources with the same defines always give back the same program, the library owns all of them
+class ShaderLibrary final {
+private:
+    std::unordered_map<std::string, std::string> mSources;
+    std::unordered_map<std::string, CompoundShader*> mVariants;
+    std::vector<std::pair<std::string, unsigned>> mUniformBlocks;
+public:
+    ShaderLibrary();
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary(ShaderLibrary&&) = delete;
+
+    ~ShaderLibrary();
+
+    ShaderLibrary& operator =(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator =(ShaderLibrary&&) = delete;
+
+    void addSource(const std::string& path, std::string source);
+    void bindUniformBlock(const std::string& name, unsigned binding);
+    CompoundShader* variant(const std::string& vertexPath, const std::string& fragmentPath, std::vector<std::string> defines);
+    int variantCount();
+private:
+    const std::string& source(const std::string& path);
+};
@@ -0,0 +1,198 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ShadowMap.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <GL/glew.h>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+static const float PADDING = 2.0f; // texels
+static const float FIT_MARGIN = 0.01f; // of the fitted extent
+
+// sized formats, so the driver doesn't pick 32 bits on its own for a plain GL_DEPTH_COMPONENT
+static void depthFormat(int depthBits, int& internalFormat, unsigned& type) {
+    switch (depthBits) {
+        case 16:
+            internalFormat = GL_DEPTH_COMPONENT16;
+            type = GL_UNSIGNED_SHORT;
+            break;
+        case 32:
+            internalFormat = GL_DEPTH_COMPONENT32F;
+            type = GL_FLOAT;
+            break;
+        default:
+            internalFormat = GL_DEPTH_COMPONENT24;
+            type = GL_UNSIGNED_INT;
+            break;
+    }
+}
+
+ShadowMap::ShadowMap(int size, int depthBits, int slots) :
+    mSize(size),
+    mFbo(0),
+    mTexture(0),
+    mLightSpaceMatrix(1.0f),
+    mTexelSize(0.0f),
+    mCasters(slots, -1),
+    mFullRedraw(true),
+    mDirty(false),
+    mDirtyMin(0.0f),
+    mDirtyMax(0.0f)
+{
+    int internalFormat;
+    unsigned type;
+    depthFormat(depthBits, internalFormat, type);
+
+    glGenTextures(1, &mTexture);
+    glBindTexture(GL_TEXTURE_2D, mTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, mSize, mSize, 0, GL_DEPTH_COMPONENT, type, nullptr);
+    // sampled through sampler2DShadow, the linear filter makes every tap a bilinear blend of four comparisons
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, (float[4]) {1.0f, 1.0f, 1.0f, 1.0f});
+
+    glGenFramebuffers(1, &mFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, mTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+ShadowMap::~ShadowMap() {
+    glDeleteTextures(1, &mTexture);
+    glDeleteFramebuffers(1, &mFbo);
+}
+
+void ShadowMap::setLightSpaceMatrix(const glm::mat4& lightSpaceMatrix) {
+    if (lightSpaceMatrix == mLightSpaceMatrix) return;
+    mLightSpaceMatrix = lightSpaceMatrix;
+    mFullRedraw = true;
+}
+
+// fits an orthographic projection looking from the light at the target around the given box of casters and receivers,
+// returns whether the projection changed, which means the whole map gets redrawn
+bool ShadowMap::fit(const glm::vec3& lightPos, const glm::vec3& target, const glm::vec3& min, const glm::vec3& max) {
+    const glm::mat4 lightView = glm::lookAt(lightPos, target, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    glm::vec3 viewMin(INFINITY), viewMax(-INFINITY);
+    for (int corner = 0; corner < 8; corner++) {
+        const glm::vec3 point(lightView * glm::vec4(
+            corner & 1 ? max.x : min.x,
+            corner & 2 ? max.y : min.y,
+            corner & 4 ? max.z : min.z,
+            1.0f
+        ));
+
+        viewMin = glm::min(viewMin, point);
+        viewMax = glm::max(viewMax, point);
+    }
+
+    const glm::vec3 margin = (viewMax - viewMin) * FIT_MARGIN;
+    viewMin = viewMin - margin;
+    viewMax = viewMax + margin;
+
+    // the light looks down its negative z axis, so the nearest point has the largest z
+    const glm::mat4 lightProjection = glm::ortho(viewMin.x, viewMax.x, viewMin.y, viewMax.y, -viewMax.z, -viewMin.z);
+    mTexelSize = std::max(viewMax.x - viewMin.x, viewMax.y - viewMin.y) / static_cast<float>(mSize);
+
+    const glm::mat4 lightSpaceMatrix = lightProjection * lightView;
+    if (lightSpaceMatrix == mLightSpaceMatrix) return false;
+
+    setLightSpaceMatrix(lightSpaceMatrix);
+    return true;
+}
+
+const glm::mat4& ShadowMap::lightSpaceMatrix() {
+    return mLightSpaceMatrix;
+}
+
+// the world space size of a texel of the current fit
+float ShadowMap::texelSize() {
+    return mTexelSize;
+}
+
+// a changed caster invalidates the texels its bounding box projects onto, whatever was in the slot before must fit the same box
+void ShadowMap::trackCaster(int slot, int caster, const glm::vec3& min, const glm::vec3& max) {
+    if (mCasters[slot] == caster) return;
+    mCasters[slot] = caster;
+    if (mFullRedraw) return;
+
+    glm::vec2 boxMin(INFINITY), boxMax(-INFINITY);
+    for (int corner = 0; corner < 8; corner++) {
+        const glm::vec4 point = mLightSpaceMatrix * glm::vec4(
+            corner & 1 ? max.x : min.x,
+            corner & 2 ? max.y : min.y,
+            corner & 4 ? max.z : min.z,
+            1.0f
+        );
+        const glm::vec2 texel((point.x / point.w * 0.5f + 0.5f) * static_cast<float>(mSize), (point.y / point.w * 0.5f + 0.5f) * static_cast<float>(mSize));
+
+        boxMin = glm::min(boxMin, texel);
+        boxMax = glm::max(boxMax, texel);
+    }
+
+    if (mDirty) {
+        mDirtyMin = glm::min(mDirtyMin, boxMin);
+        mDirtyMax = glm::max(mDirtyMax, boxMax);
+    } else {
+        mDirtyMin = boxMin;
+        mDirtyMax = boxMax;
+        mDirty = true;
+    }
+}
+
+bool ShadowMap::begin() {
+    if (!mFullRedraw && !mDirty) return false;
+
+    glViewport(0, 0, mSize, mSize);
+    glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
+
+    if (!mFullRedraw) {
+        const int x = std::max(0, static_cast<int>(std::floor(mDirtyMin.x - PADDING)));
+        const int y = std::max(0, static_cast<int>(std::floor(mDirtyMin.y - PADDING)));
+        const int right = std::min(mSize, static_cast<int>(std::ceil(mDirtyMax.x + PADDING)));
+        const int top = std::min(mSize, static_cast<int>(std::ceil(mDirtyMax.y + PADDING)));
+
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(x, y, std::max(0, right - x), std::max(0, top - y));
+    }
+
+    glClear(GL_DEPTH_BUFFER_BIT);
+    return true;
+}
+
+void ShadowMap::end() {
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    mFullRedraw = false;
+    mDirty = false;
+}
+
+unsigned ShadowMap::texture() {
+    return mTexture;
+}
@@ -0,0 +1,52 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// keeps the depth map of the previous frames and redraws only the texels covered by casters that have changed since then
+class ShadowMap final {
+private:
+    const int mSize;
+    unsigned mFbo, mTexture;
+    glm::mat4 mLightSpaceMatrix;
+    float mTexelSize;
+    std::vector<int> mCasters;
+    bool mFullRedraw, mDirty;
+    glm::vec2 mDirtyMin, mDirtyMax;
+public:
+    ShadowMap(int size, int depthBits, int slots);
+    ShadowMap(const ShadowMap&) = delete;
+    ShadowMap(ShadowMap&&) = delete;
+
+    ~ShadowMap();
+
+    ShadowMap& operator =(const ShadowMap&) = delete;
+    ShadowMap& operator =(ShadowMap&&) = delete;
+
+    void setLightSpaceMatrix(const glm::mat4& lightSpaceMatrix);
+    bool fit(const glm::vec3& lightPos, const glm::vec3& target, const glm::vec3& min, const glm::vec3& max);
+    const glm::mat4& lightSpaceMatrix();
+    float texelSize();
+    void trackCaster(int slot, int caster, const glm::vec3& min, const glm::vec3& max);
+    bool begin();
+    void end();
+    unsigned texture();
+};
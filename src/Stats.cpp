@@ -0,0 +1,54 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Stats.hpp"
+
+Stats gStats = {};
+
+const char* Stats::counterName(Counter counter) {
+    switch (counter) {
+        case DRAW_CALLS:
+            return "draw calls";
+        case PROGRAM_BINDS:
+            return "program binds";
+        case ELIDED_PROGRAM_BINDS:
+            return "elided program binds";
+        case ELIDED_VERTEX_ARRAY_BINDS:
+            return "elided vao binds";
+        case ELIDED_STATE_CHANGES:
+            return "elided state changes";
+        case UNIFORM_UPLOADS:
+            return "uniform uploads";
+        case TRIANGLES:
+            return "triangles";
+        case LOD0_TRIANGLES:
+            return "lod 0 triangles";
+        case LOD1_TRIANGLES:
+            return "lod 1 triangles";
+        case LOD2_TRIANGLES:
+            return "lod 2 triangles";
+        case LOD3_TRIANGLES:
+            return "lod 3 triangles";
+        case INSTANCES_SUBMITTED:
+            return "instances drawn";
+        case INSTANCES_CULLED:
+            return "instances culled";
+        default:
+            return "";
+    }
+}
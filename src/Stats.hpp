@@ -0,0 +1,49 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// counters of the work submitted to the driver, the profiler snapshots and resets them at the end of every frame
+struct Stats {
+    enum Counter {
+        DRAW_CALLS,
+        PROGRAM_BINDS,
+        ELIDED_PROGRAM_BINDS,
+        ELIDED_VERTEX_ARRAY_BINDS,
+        ELIDED_STATE_CHANGES,
+        UNIFORM_UPLOADS,
+        TRIANGLES,
+        LOD0_TRIANGLES,
+        LOD1_TRIANGLES,
+        LOD2_TRIANGLES,
+        LOD3_TRIANGLES,
+        INSTANCES_SUBMITTED,
+        INSTANCES_CULLED,
+        COUNTER_COUNT
+    };
+
+    unsigned long counters[COUNTER_COUNT];
+
+    void count(Counter counter, unsigned long amount = 1) {
+        counters[counter] += amount;
+    }
+
+    static const char* counterName(Counter counter);
+};
+
+extern Stats gStats;
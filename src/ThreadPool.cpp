@@ -0,0 +1,63 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads) : mWorkers(), mTasks(), mMutex(), mWake(), mStopping(false) {
+    for (int i = 0; i < threads; i++)
+        mWorkers.emplace_back(&ThreadPool::work, this);
+}
+
+// the queued tasks are finished before the workers are joined
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+
+    for (auto& worker : mWorkers)
+        worker.join();
+}
+
+int ThreadPool::size() {
+    return (int) mWorkers.size();
+}
+
+// one thread is left for the caller
+int ThreadPool::defaultSize() {
+    return std::max(1, (int) std::thread::hardware_concurrency() - 1);
+}
+
+void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock(mMutex);
+            mWake.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+            if (mTasks.empty()) return;
+
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a fixed set of workers taking tasks in submission order
+class ThreadPool final {
+private:
+    std::vector<std::thread> mWorkers;
+    std::deque<std::function<void()>> mTasks;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    bool mStopping;
+public:
+    explicit ThreadPool(int threads);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+
+    ~ThreadPool();
+
+    ThreadPool& operator =(const ThreadPool&) = delete;
+    ThreadPool& operator =(ThreadPool&&) = delete;
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& function) {
+        // std::function has to be copyable, the task isn't, so it's shared
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(function));
+        auto future = task->get_future();
+
+        {
+            std::lock_guard lock(mMutex);
+            mTasks.emplace_back([task]() { (*task)(); });
+        }
+        mWake.notify_one();
+
+        return future;
+    }
+
+    int size();
+    static int defaultSize();
+private:
+    void work();
+};
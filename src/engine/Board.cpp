@@ -0,0 +1,211 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Board.hpp"
+#include <cassert>
+
+enum Direction {
+    UP_LEFT = 0,
+    UP_RIGHT = 1,
+    DOWN_LEFT = 2,
+    DOWN_RIGHT = 3
+};
+
+// a step in either direction along a diagonal moves by a different number of squares on even and on odd rows
+struct Step {
+    uint32_t evenMask, oddMask;
+    int even, odd;
+};
+
+// the squares on rows of the given parity whose diagonal neighbour lies on the board
+static constexpr uint32_t stepMask(int parity, int di, int dj) {
+    uint32_t mask = 0;
+    for (int square = 0; square < Board::SQUARES; square++) {
+        const int j = square / 4, i = square % 4 * 2 + j % 2;
+        if (j % 2 == parity && i + di >= 0 && i + di < Board::SIZE && j + dj >= 0 && j + dj < Board::SIZE)
+            mask |= 1u << square;
+    }
+    return mask;
+}
+
+static constexpr Step STEPS[4] = {
+    {stepMask(0, -1, 1), stepMask(1, -1, 1), 3, 4},
+    {stepMask(0, 1, 1), stepMask(1, 1, 1), 4, 5},
+    {stepMask(0, -1, -1), stepMask(1, -1, -1), -5, -4},
+    {stepMask(0, 1, -1), stepMask(1, 1, -1), -4, -3}
+};
+
+// the rows where the men of each side are crowned
+static constexpr uint32_t CROWNING[2] = {0xf0000000u, 0x0000000fu};
+
+static inline uint32_t shift(uint32_t squares, int amount) {
+    return amount > 0 ? squares << amount : squares >> -amount;
+}
+
+// moves every square of the set one cell along the direction, those that would leave the board drop out
+static inline uint32_t step(uint32_t squares, int direction) {
+    const Step& s = STEPS[direction];
+    return shift(squares & s.evenMask, s.even) | shift(squares & s.oddMask, s.odd);
+}
+
+static inline int opposite(int direction) {
+    return 3 - direction;
+}
+
+// men only go forward, white's forward is up and black's is down
+static inline int firstDirection(Board::Side side, bool king) {
+    return king || side == Board::WHITE ? UP_LEFT : DOWN_LEFT;
+}
+
+static inline int lastDirection(Board::Side side, bool king) {
+    return king || side == Board::BLACK ? DOWN_RIGHT : UP_RIGHT;
+}
+
+static inline uint32_t lowestBit(uint32_t squares) {
+    return squares & -squares;
+}
+
+static void add(MoveList& list, uint32_t from, uint32_t to, uint32_t captured) {
+    assert(list.count < MoveList::CAPACITY);
+    list.moves[list.count++] = Move{from, to, captured};
+}
+
+// follows every chain of jumps from the square, a jumped piece stays on the board until the move ends
+// so it can't be jumped twice, and a man that reaches the far row is crowned and stops there;
+// a king taking the same pieces in another order makes another move, as the published perft counts have it
+static void addJumps(MoveList& list, Board::Side side, bool king, uint32_t from, uint32_t at, uint32_t captured, uint32_t opponents, uint32_t empty) {
+    bool extended = false;
+
+    for (int direction = firstDirection(side, king); direction <= lastDirection(side, king); direction++) {
+        const uint32_t jumped = step(at, direction) & opponents & ~captured;
+        if (jumped == 0) continue;
+
+        const uint32_t landing = step(jumped, direction) & empty;
+        if (landing == 0) continue;
+
+        extended = true;
+        if (!king && (landing & CROWNING[side]) != 0)
+            add(list, from, landing, captured | jumped);
+        else
+            addJumps(list, side, king, from, landing, captured | jumped, opponents, empty);
+    }
+
+    if (!extended && captured != 0)
+        add(list, from, at, captured);
+}
+
+uint32_t Board::own() const {
+    return side == WHITE ? white : black;
+}
+
+uint32_t Board::opponent() const {
+    return side == WHITE ? black : white;
+}
+
+uint32_t Board::empty() const {
+    return ~(white | black);
+}
+
+void Board::moves(MoveList& list) const {
+    list.count = 0;
+
+    const uint32_t pieces = own(), opponents = opponent(), free = empty();
+    const uint32_t ownKings = pieces & kings;
+
+    // the pieces that can jump at all, found for the whole set at once
+    uint32_t jumpers = 0;
+    for (int direction = UP_LEFT; direction <= DOWN_RIGHT; direction++) {
+        const uint32_t movers = direction >= firstDirection(side, false) && direction <= lastDirection(side, false) ? pieces : ownKings;
+        const uint32_t landings = step(step(movers, direction) & opponents, direction) & free;
+        jumpers |= step(step(landings, opposite(direction)), opposite(direction));
+    }
+
+    if (jumpers != 0) {
+        for (; jumpers != 0; jumpers &= jumpers - 1) {
+            const uint32_t from = lowestBit(jumpers);
+            addJumps(list, side, (from & kings) != 0, from, from, 0, opponents, free | from);
+        }
+        return;
+    }
+
+    for (int direction = UP_LEFT; direction <= DOWN_RIGHT; direction++) {
+        const uint32_t movers = direction >= firstDirection(side, false) && direction <= lastDirection(side, false) ? pieces : ownKings;
+        for (uint32_t targets = step(movers, direction) & free; targets != 0; targets &= targets - 1) {
+            const uint32_t to = lowestBit(targets);
+            add(list, step(to, opposite(direction)), to, 0);
+        }
+    }
+}
+
+Board Board::played(const Move& move) const {
+    Board next = *this;
+    uint32_t& pieces = side == WHITE ? next.white : next.black, & opponents = side == WHITE ? next.black : next.white;
+
+    const bool king = (kings & move.from) != 0;
+    pieces = (pieces & ~move.from) | move.to;
+    opponents &= ~move.captured;
+
+    next.kings &= ~(move.from | move.captured);
+    if (king || (move.to & CROWNING[side]) != 0)
+        next.kings |= move.to;
+
+    next.side = side == WHITE ? BLACK : WHITE;
+    return next;
+}
+
+void Board::retractions(MoveList& list) const {
+    list.count = 0;
+
+    const Side mover = side == WHITE ? BLACK : WHITE;
+    const uint32_t pieces = opponent(), free = empty();
+    const uint32_t moverKings = pieces & kings;
+
+    for (int direction = UP_LEFT; direction <= DOWN_RIGHT; direction++) {
+        const uint32_t movers = direction >= firstDirection(mover, false) && direction <= lastDirection(mover, false) ? pieces : moverKings;
+        for (uint32_t origins = step(movers, opposite(direction)) & free; origins != 0; origins &= origins - 1) {
+            const uint32_t from = lowestBit(origins);
+            add(list, from, step(from, direction), 0);
+        }
+    }
+}
+
+Board Board::retracted(const Move& move) const {
+    Board previous = *this;
+    uint32_t& pieces = side == WHITE ? previous.black : previous.white;
+
+    pieces = (pieces & ~move.to) | move.from;
+    if ((kings & move.to) != 0)
+        previous.kings = (previous.kings & ~move.to) | move.from;
+
+    previous.side = side == WHITE ? BLACK : WHITE;
+    return previous;
+}
+
+Board Board::initial() {
+    return Board{0x00000fffu, 0xfff00000u, 0, BLACK};
+}
+
+int Board::square(int i, int j) {
+    if (i < 0 || i >= SIZE || j < 0 || j >= SIZE || (i + j) % 2 != 0) return -1;
+    return j * 4 + i / 2;
+}
+
+void Board::cell(int square, int& i, int& j) {
+    j = square / 4;
+    i = square % 4 * 2 + j % 2;
+}
@@ -0,0 +1,64 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// a move as the squares it starts and ends on and the squares it jumps over
+struct Move {
+    uint32_t from, to, captured;
+};
+
+struct MoveList {
+    static const int CAPACITY = 128;
+
+    Move moves[CAPACITY];
+    int count;
+};
+
+// the 32 dark cells of the board as bitboards, cell (i, j) with (i + j) even is bit j * 4 + i / 2,
+// white starts on the rows 0 to 2 and moves towards row 7, black starts on the rows 5 to 7 and moves first
+struct Board {
+    enum Side {
+        WHITE = 0,
+        BLACK = 1
+    };
+
+    static const int SIZE = 8, SQUARES = 32;
+
+    uint32_t white, black, kings;
+    Side side;
+
+    uint32_t own() const;
+    uint32_t opponent() const;
+    uint32_t empty() const;
+
+    // fills the list with the legal moves of the side to move, only captures if there are any
+    void moves(MoveList& list) const;
+    Board played(const Move& move) const;
+    // fills the list with the steps the side that just moved could have made to get here, without checking that
+    // the side had no capture then; moves that captured or crowned led here from another material and aren't among them
+    void retractions(MoveList& list) const;
+    Board retracted(const Move& move) const;
+
+    static Board initial();
+    // -1 for the light cells, which never hold a piece
+    static int square(int i, int j);
+    static void cell(int square, int& i, int& j);
+};
@@ -0,0 +1,47 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Evaluation.hpp"
+
+static const int MAN = 100, KING = 150, ADVANCE = 3, BACK_ROW = 10, CENTER = 4;
+
+static const uint32_t ROWS[Board::SIZE] = {
+    0x0000000fu, 0x000000f0u, 0x00000f00u, 0x0000f000u,
+    0x000f0000u, 0x00f00000u, 0x0f000000u, 0xf0000000u
+};
+
+// the four dark cells in the middle of the board
+static const uint32_t CENTER_SQUARES = 0x00066000u;
+
+// men score for how far they've come, except those still guarding their own back row
+// which keep the other side's men from being crowned
+static int score(uint32_t pieces, uint32_t kings, Board::Side side) {
+    const uint32_t men = pieces & ~kings;
+    int value = __builtin_popcount(men) * MAN + __builtin_popcount(pieces & kings) * KING;
+
+    for (int row = 1; row < Board::SIZE; row++)
+        value += __builtin_popcount(men & ROWS[side == Board::WHITE ? row : Board::SIZE - 1 - row]) * row * ADVANCE;
+
+    value += __builtin_popcount(men & ROWS[side == Board::WHITE ? 0 : Board::SIZE - 1]) * BACK_ROW;
+    return value + __builtin_popcount(pieces & CENTER_SQUARES) * CENTER;
+}
+
+int evaluate(const Board& board) {
+    const int white = score(board.white, board.kings, Board::WHITE), black = score(board.black, board.kings, Board::BLACK);
+    return board.side == Board::WHITE ? white - black : black - white;
+}
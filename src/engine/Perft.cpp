@@ -0,0 +1,32 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Perft.hpp"
+
+uint64_t perft(const Board& board, int depth) {
+    if (depth == 0) return 1;
+
+    MoveList list;
+    board.moves(list);
+    if (depth == 1) return static_cast<uint64_t>(list.count);
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < list.count; i++)
+        nodes += perft(board.played(list.moves[i]), depth - 1);
+    return nodes;
+}
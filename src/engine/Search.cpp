@@ -0,0 +1,283 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Search.hpp"
+#include "Evaluation.hpp"
+#include "Tablebase.hpp"
+#include "Zobrist.hpp"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static const int INFINITE = Search::WIN + 1;
+// scores past this are won or lost games, searched or probed, as WIN less the plies from the root to the end,
+// which for a probed one runs on past the deepest ply by as much as the longest distance in the tables
+static const int DECIDED = Search::WIN - Search::MAX_PLY - TABLEBASE_MAX_DISTANCE - 1;
+static const int TABLE_MOVE = 1 << 30, CAPTURE = 1 << 29, KILLER = 1 << 28, HISTORY_LIMIT = 1 << 20;
+
+// what each thread keeps to itself, only the table and the stop flag are shared
+struct Worker {
+    TranspositionTable* table;
+    std::atomic<bool>* stop;
+    const std::atomic<bool>* cancel;
+    Tablebase* tablebase;
+    std::chrono::steady_clock::time_point deadline;
+    bool timed, main;
+    uint64_t nodes;
+    int rootMove;
+    // quiet moves that refuted another move at the same ply, and how often a quiet move refuted anything
+    Move killers[Search::MAX_PLY][2];
+    int history[2][Board::SQUARES][Board::SQUARES];
+};
+
+static inline bool same(const Move& a, const Move& b) {
+    return a.from == b.from && a.to == b.to && a.captured == b.captured;
+}
+
+static inline bool cancelled(const Worker& worker) {
+    return worker.cancel != nullptr && worker.cancel->load(std::memory_order_relaxed);
+}
+
+// wins are stored as distances from the stored position rather than from the root
+static inline int toTable(int score, int ply) {
+    if (score > DECIDED) return score + ply;
+    return score < -DECIDED ? score - ply : score;
+}
+
+static inline int fromTable(int score, int ply) {
+    if (score > DECIDED) return score - ply;
+    return score < -DECIDED ? score + ply : score;
+}
+
+// jumps taking the most pieces first, then the killers, then the quiet moves by their history
+static int orderScore(const Worker& worker, Board::Side side, const Move& move, int ply) {
+    if (move.captured != 0) return CAPTURE + __builtin_popcount(move.captured);
+    if (same(move, worker.killers[ply][0])) return KILLER + 1;
+    if (same(move, worker.killers[ply][1])) return KILLER;
+    return worker.history[side][__builtin_ctz(move.from)][__builtin_ctz(move.to)];
+}
+
+static void remember(Worker& worker, Board::Side side, const Move& move, int depth, int ply) {
+    if (!same(move, worker.killers[ply][0])) {
+        worker.killers[ply][1] = worker.killers[ply][0];
+        worker.killers[ply][0] = move;
+    }
+
+    int& history = worker.history[side][__builtin_ctz(move.from)][__builtin_ctz(move.to)];
+    history += depth * depth;
+    if (history < HISTORY_LIMIT) return;
+
+    // halving the whole table keeps the order and makes recent cutoffs count more than old ones
+    for (auto& from : worker.history[side]) {
+        for (int& value : from)
+            value /= 2;
+    }
+}
+
+static int search(Worker& worker, const Board& board, uint64_t key, int depth, int alpha, int beta, int ply) {
+    if ((++worker.nodes & 1023) == 0 && worker.main && (cancelled(worker) || (worker.timed && std::chrono::steady_clock::now() >= worker.deadline)))
+        worker.stop->store(true, std::memory_order_relaxed);
+    if (worker.stop->load(std::memory_order_relaxed)) return 0;
+
+    // an endgame the tablebase covers is settled by one lookup, scored like a searched win that ends as many plies on
+    Outcome outcome;
+    int distance;
+    if (ply > 0 && worker.tablebase != nullptr && worker.tablebase->probe(board, outcome, distance)) {
+        if (outcome == DRAW) return 0;
+        return outcome == WIN ? Search::WIN - ply - distance : -Search::WIN + ply + distance;
+    }
+
+    MoveList list;
+    board.moves(list);
+    if (list.count == 0) return -Search::WIN + ply;
+    if (ply >= Search::MAX_PLY - 1) return evaluate(board);
+
+    // jumps are forced, so the search goes on through them until the position is quiet
+    if (depth <= 0 && list.moves[0].captured == 0) return evaluate(board);
+    depth = std::max(depth, 0);
+
+    int tableMove = TranspositionTable::NO_MOVE;
+    TranspositionTable::Entry entry;
+    if (worker.table->probe(key, entry)) {
+        tableMove = entry.move;
+        const int score = fromTable(entry.score, ply);
+
+        if (ply > 0 && entry.depth >= depth) {
+            if (entry.bound == TranspositionTable::EXACT) return score;
+            if (entry.bound == TranspositionTable::LOWER && score >= beta) return score;
+            if (entry.bound == TranspositionTable::UPPER && score <= alpha) return score;
+        }
+    }
+
+    int order[MoveList::CAPACITY], scores[MoveList::CAPACITY];
+    for (int i = 0; i < list.count; i++) {
+        order[i] = i;
+        scores[i] = i == tableMove ? TABLE_MOVE : orderScore(worker, board.side, list.moves[i], ply);
+    }
+
+    int best = -INFINITE, bestMove = 0;
+    auto bound = TranspositionTable::UPPER;
+
+    for (int n = 0; n < list.count; n++) {
+        // sorted a move at a time, a cutoff mostly comes before the rest would be needed
+        int pick = n;
+        for (int i = n + 1; i < list.count; i++) {
+            if (scores[order[i]] > scores[order[pick]]) pick = i;
+        }
+        std::swap(order[n], order[pick]);
+
+        const Move& move = list.moves[order[n]];
+        const Board child = board.played(move);
+        const uint64_t childKey = zobristPlayed(key, board, child);
+
+        // the first move is expected to be the best, the others only have to be proven worse with a null window
+        int score;
+        if (n == 0) {
+            score = -search(worker, child, childKey, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            score = -search(worker, child, childKey, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta)
+                score = -search(worker, child, childKey, depth - 1, -beta, -alpha, ply + 1);
+        }
+        if (worker.stop->load(std::memory_order_relaxed)) return 0;
+
+        if (score > best) {
+            best = score;
+            bestMove = order[n];
+            if (ply == 0) worker.rootMove = bestMove;
+        }
+
+        if (score > alpha) {
+            alpha = score;
+            bound = TranspositionTable::EXACT;
+        }
+
+        if (alpha >= beta) {
+            bound = TranspositionTable::LOWER;
+            if (move.captured == 0) remember(worker, board.side, move, depth, ply);
+            break;
+        }
+    }
+
+    worker.table->store(key, toTable(best, ply), depth, bound, bestMove);
+    return best;
+}
+
+// the helpers search every other iteration a ply deeper than the main thread and only the main thread reports
+static void iterate(
+    Worker& worker,
+    const Board& board,
+    const SearchLimits& limits,
+    int id,
+    SearchReport* report,
+    std::chrono::steady_clock::time_point start,
+    const std::function<void(const SearchReport&)>& progress
+) {
+    const uint64_t key = zobristKey(board);
+    MoveList list;
+    board.moves(list);
+
+    const int maxDepth = limits.depth > 0 ? std::min(limits.depth, Search::MAX_PLY - 1) : Search::MAX_PLY - 1;
+    uint64_t previousNodes = 0;
+
+    for (int depth = 1; depth <= maxDepth && !cancelled(worker); depth++) {
+        const uint64_t nodes = worker.nodes;
+        const int score = search(worker, board, key, std::min(depth + id % 2, maxDepth), -INFINITE, INFINITE, 0);
+        if (worker.stop->load(std::memory_order_relaxed)) break;
+        if (report == nullptr) continue;
+
+        report->move = list.moves[worker.rootMove];
+        report->score = score;
+        report->depth = depth;
+        report->branching = previousNodes > 0 ? static_cast<double>(worker.nodes - nodes) / static_cast<double>(previousNodes) : 0.0;
+        previousNodes = worker.nodes - nodes;
+
+        if (progress) {
+            report->nodes = worker.nodes;
+            report->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            progress(*report);
+        }
+
+        // a decided game stays decided, and the next iteration wouldn't finish in less time than all before it took
+        if (std::abs(score) > DECIDED) break;
+        if (worker.timed && (std::chrono::steady_clock::now() - start) * 2 > worker.deadline - start) break;
+    }
+
+    if (report != nullptr)
+        worker.stop->store(true, std::memory_order_relaxed);
+}
+
+Search::Search(int tableMegabytes) : mTable(tableMegabytes), mStop(false), mTablebase(nullptr) {}
+
+SearchReport Search::run(
+    const Board& board,
+    const SearchLimits& limits,
+    const std::atomic<bool>* cancel,
+    const std::function<void(const SearchReport&)>& progress
+) {
+    assert(limits.depth > 0 || limits.milliseconds > 0);
+    const auto start = std::chrono::steady_clock::now();
+
+    MoveList list;
+    board.moves(list);
+    assert(list.count > 0);
+
+    SearchReport report{list.moves[0], 0, 0, 0, 0.0, 0.0};
+    if (list.count == 1) return report;
+
+    mStop.store(false);
+    mTable.nextGeneration();
+
+    const int threads = std::max(limits.threads, 1);
+    auto workers = new Worker[threads]();
+    for (int i = 0; i < threads; i++) {
+        workers[i].table = &mTable;
+        workers[i].stop = &mStop;
+        workers[i].cancel = cancel;
+        workers[i].tablebase = mTablebase;
+        workers[i].deadline = start + std::chrono::milliseconds(limits.milliseconds);
+        workers[i].timed = limits.milliseconds > 0;
+        workers[i].main = i == 0;
+    }
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threads; i++)
+        helpers.emplace_back([&, i]() { iterate(workers[i], board, limits, i, nullptr, start, {}); });
+
+    iterate(workers[0], board, limits, 0, &report, start, progress);
+    for (auto& helper : helpers)
+        helper.join();
+
+    for (int i = 0; i < threads; i++)
+        report.nodes += workers[i].nodes;
+    delete[] workers;
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+void Search::useTablebase(Tablebase* tablebase) {
+    mTablebase = tablebase;
+}
+
+int Search::defaultThreads() {
+    return std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+}
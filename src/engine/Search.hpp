@@ -0,0 +1,72 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Board.hpp"
+#include "TranspositionTable.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+class Tablebase;
+
+// zero leaves a limit out, at least one of depth and milliseconds has to be set
+struct SearchLimits {
+    int depth, milliseconds, threads;
+};
+
+struct SearchReport {
+    Move move;
+    int score, depth;
+    uint64_t nodes;
+    double seconds;
+    // nodes of the last completed iteration over those of the one before it
+    double branching;
+};
+
+// iterative deepening principal variation search, run by several threads at once that only share
+// the transposition table (Lazy SMP) and spread over depths so each finds the others' results there
+class Search final {
+public:
+    static const int MAX_PLY = 128, WIN = 30000;
+private:
+    TranspositionTable mTable;
+    std::atomic<bool> mStop;
+    Tablebase* mTablebase;
+public:
+    explicit Search(int tableMegabytes);
+    Search(const Search&) = delete;
+    Search(Search&&) = delete;
+
+    Search& operator =(const Search&) = delete;
+    Search& operator =(Search&&) = delete;
+
+    // the side to move has to have a legal move, once cancel is set from any thread the search returns what its
+    // last completed iteration found, and progress gets each completed iteration on the calling thread
+    SearchReport run(
+        const Board& board,
+        const SearchLimits& limits,
+        const std::atomic<bool>* cancel = nullptr,
+        const std::function<void(const SearchReport&)>& progress = {}
+    );
+    // positions with few enough pieces are looked up instead of searched, nullptr turns that off
+    void useTablebase(Tablebase* tablebase);
+
+    static int defaultThreads();
+};
@@ -0,0 +1,157 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Tablebase.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// the files are opened up front and never afterwards, a table missing or broken for some material of a piece
+// count rules out the whole count; on pages the windows can't be aligned to no table is used at all
+Tablebase::Tablebase(const std::string& directory) : mDirectory(directory), mTables(), mWindows(), mClock(0), mPieces(0) {
+    const long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0 || WINDOW_BYTES % page != 0 || TABLEBASE_HEADER_BYTES % page != 0) {
+        fprintf(stderr, "tablebase unusable with %ld byte pages\n", page);
+        return;
+    }
+
+    for (int pieces = 2;; pieces++) {
+        bool complete = true;
+        for (const Material& material : Material::upTo(pieces)) {
+            if (material.pieces() == pieces && !load(material))
+                complete = false;
+        }
+
+        if (!complete) break;
+        mPieces = pieces;
+    }
+}
+
+Tablebase::~Tablebase() {
+    for (const Window& window : mWindows) {
+        if (window.data != nullptr)
+            munmap(const_cast<uint8_t*>(window.data), WINDOW_BYTES);
+    }
+
+    for (const auto& [material, table] : mTables)
+        close(table.file);
+}
+
+int Tablebase::pieces() {
+    return mPieces;
+}
+
+bool Tablebase::probe(const Board& board, Outcome& outcome, int& distance) {
+    if (__builtin_popcount(board.white | board.black) > mPieces) return false;
+
+    // a side without pieces has lost, there are no tables for that
+    if ((board.side == Board::WHITE ? board.white : board.black) == 0) {
+        outcome = LOSS;
+        distance = 0;
+        return true;
+    }
+
+    const Material material = Material::of(board);
+    const uint64_t index = material.index(board);
+
+    // every table up to mPieces was opened by the constructor, so this only ever reads mTables
+    const auto found = mTables.find(material.key());
+    if (found == mTables.end() || index >= found->second.entries) return false;
+
+    const uint64_t number = index / WINDOW_BYTES;
+
+    // windows that are already mapped are read under the shared lock, so probes that hit don't wait on each other
+    {
+        std::shared_lock lock(mMutex);
+        const uint8_t* data = mapped(material.key(), number);
+        if (data != nullptr) {
+            outcome = decodeValue(data[index % WINDOW_BYTES], distance);
+            return true;
+        }
+    }
+
+    // another thread may have mapped the window between the two locks
+    std::lock_guard lock(mMutex);
+    const uint8_t* data = mapped(material.key(), number);
+    if (data == nullptr) data = map(material.key(), found->second, number);
+    if (data == nullptr) return false;
+
+    outcome = decodeValue(data[index % WINDOW_BYTES], distance);
+    return true;
+}
+
+// a file has to be as long as its header says, a shorter one would fault when a window past its end is read
+bool Tablebase::load(const Material& material) {
+    const int file = open((mDirectory + "/" + material.fileName()).c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) return false;
+
+    TablebaseHeader header;
+    struct stat status;
+    const bool valid = pread(file, &header, sizeof header, 0) == sizeof header
+        && memcmp(header.magic, TABLEBASE_MAGIC, sizeof TABLEBASE_MAGIC) == 0
+        && header.version == TABLEBASE_VERSION
+        && header.material[0] == material.whiteMen
+        && header.material[1] == material.whiteKings
+        && header.material[2] == material.blackMen
+        && header.material[3] == material.blackKings
+        && header.entries == material.size()
+        && fstat(file, &status) == 0
+        && static_cast<uint64_t>(status.st_size) >= TABLEBASE_HEADER_BYTES + header.entries;
+
+    if (!valid) {
+        close(file);
+        return false;
+    }
+
+    mTables.emplace(material.key(), Table{file, header.entries});
+    return true;
+}
+
+// called under either lock, the use is stamped atomically since several readers may stamp at once
+const uint8_t* Tablebase::mapped(int material, uint64_t number) {
+    for (Window& window : mWindows) {
+        if (window.data != nullptr && window.material == material && window.number == number) {
+            window.lastUse.store(++mClock, std::memory_order_relaxed);
+            return window.data;
+        }
+    }
+    return nullptr;
+}
+
+// called under the exclusive lock, the least recently used window gives its mapping to the new one
+const uint8_t* Tablebase::map(int material, const Table& table, uint64_t number) {
+    Window* victim = &mWindows[0];
+    for (Window& window : mWindows) {
+        if (window.lastUse.load(std::memory_order_relaxed) < victim->lastUse.load(std::memory_order_relaxed))
+            victim = &window;
+    }
+
+    if (victim->data != nullptr)
+        munmap(const_cast<uint8_t*>(victim->data), WINDOW_BYTES);
+
+    // the last window of a table reaches past the end of the file, no index ever falls into that part
+    void* data = mmap(nullptr, WINDOW_BYTES, PROT_READ, MAP_SHARED, table.file, TABLEBASE_HEADER_BYTES + static_cast<off_t>(number) * WINDOW_BYTES);
+    victim->data = data == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(data);
+    victim->material = material;
+    victim->number = number;
+    victim->lastUse.store(++mClock, std::memory_order_relaxed);
+    return victim->data;
+}
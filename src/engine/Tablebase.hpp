@@ -0,0 +1,72 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Board.hpp"
+#include "TablebaseFormat.hpp"
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+// looks positions up in the table files of a directory, mapping them a window at a time and keeping only the
+// most recently used windows mapped, so probing never brings a whole table into memory
+class Tablebase final {
+public:
+    static const int WINDOW_BYTES = 1 << 16, WINDOW_COUNT = 64;
+private:
+    struct Table {
+        int file;
+        uint64_t entries;
+    };
+
+    struct Window {
+        int material;
+        uint64_t number;
+        const uint8_t* data;
+        std::atomic<uint64_t> lastUse;
+    };
+
+    std::string mDirectory;
+    std::unordered_map<int, Table> mTables;
+    Window mWindows[WINDOW_COUNT];
+    std::atomic<uint64_t> mClock;
+    int mPieces;
+    std::shared_mutex mMutex;
+public:
+    explicit Tablebase(const std::string& directory);
+    Tablebase(const Tablebase&) = delete;
+    Tablebase(Tablebase&&) = delete;
+
+    ~Tablebase();
+
+    Tablebase& operator =(const Tablebase&) = delete;
+    Tablebase& operator =(Tablebase&&) = delete;
+
+    // the most pieces for which every table is there, 0 when there are none
+    int pieces();
+    // safe to call from several search threads at once, which only wait on each other while a window is being
+    // mapped, false when the position isn't covered
+    bool probe(const Board& board, Outcome& outcome, int& distance);
+private:
+    bool load(const Material& material);
+    const uint8_t* mapped(int material, uint64_t number);
+    const uint8_t* map(int material, const Table& table, uint64_t number);
+};
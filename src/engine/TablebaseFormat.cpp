@@ -0,0 +1,200 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TablebaseFormat.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+// white men never stand on row 7 and black men never on row 0, where they'd have been crowned
+static const uint32_t ROW_0 = 0x0000000fu, MIDDLE_ROWS = 0x0ffffff0u, ROW_7 = 0xf0000000u;
+
+struct Binomials {
+    uint64_t values[Board::SQUARES + 1][Board::SQUARES + 1];
+};
+
+static constexpr Binomials makeBinomials() {
+    Binomials binomials{};
+    for (int n = 0; n <= Board::SQUARES; n++) {
+        binomials.values[n][0] = 1;
+        for (int k = 1; k <= n; k++)
+            binomials.values[n][k] = binomials.values[n - 1][k - 1] + (k < n ? binomials.values[n - 1][k] : 0);
+    }
+    return binomials;
+}
+
+static constexpr Binomials BINOMIALS = makeBinomials();
+
+static inline uint64_t choose(int n, int k) {
+    return k < 0 || k > n ? 0 : BINOMIALS.values[n][k];
+}
+
+// the colexicographic rank of the set among all sets of its size made of the available squares
+static uint64_t rankSet(uint32_t set, uint32_t available) {
+    uint64_t rank = 0;
+    int k = 0;
+    for (; set != 0; set &= set - 1)
+        rank += choose(__builtin_popcount(available & ((set & -set) - 1)), ++k);
+    return rank;
+}
+
+static uint32_t unrankSet(uint64_t rank, int count, uint32_t available) {
+    uint32_t set = 0;
+    int limit = __builtin_popcount(available);
+
+    for (int k = count; k >= 1; k--) {
+        int position = k - 1;
+        while (position + 1 < limit && choose(position + 1, k) <= rank)
+            position++;
+        rank -= choose(position, k);
+        limit = position;
+
+        uint32_t square = available;
+        for (int i = 0; i < position; i++)
+            square &= square - 1;
+        set |= square & -square;
+    }
+    return set;
+}
+
+// the white men are split by how many stand on row 0, as those don't take squares black men could use,
+// which keeps the number of black men's placements the same throughout a part and the index free of gaps
+static uint64_t menPart(const Material& material, int onRow0) {
+    const int rest = material.whiteMen - onRow0;
+    return choose(4, onRow0) * choose(24, rest) * choose(28 - rest, material.blackMen);
+}
+
+static uint64_t menCount(const Material& material) {
+    uint64_t count = 0;
+    for (int onRow0 = 0; onRow0 <= std::min(4, material.whiteMen); onRow0++)
+        count += menPart(material, onRow0);
+    return count;
+}
+
+static uint64_t kingCount(const Material& material) {
+    const int free = Board::SQUARES - material.whiteMen - material.blackMen;
+    return choose(free, material.whiteKings) * choose(free - material.whiteKings, material.blackKings);
+}
+
+int Material::pieces() const {
+    return whiteMen + whiteKings + blackMen + blackKings;
+}
+
+int Material::key() const {
+    return whiteMen | whiteKings << 8 | blackMen << 16 | blackKings << 24;
+}
+
+std::string Material::fileName() const {
+    char name[32];
+    snprintf(name, sizeof name, "w%d%d-b%d%d.jtb", whiteMen, whiteKings, blackMen, blackKings);
+    return name;
+}
+
+uint64_t Material::size() const {
+    return 2 * menCount(*this) * kingCount(*this);
+}
+
+uint64_t Material::index(const Board& board) const {
+    const uint32_t whiteMen = board.white & ~board.kings, blackMen = board.black & ~board.kings;
+    const int onRow0 = __builtin_popcount(whiteMen & ROW_0);
+
+    uint64_t men = 0;
+    for (int part = 0; part < onRow0; part++)
+        men += menPart(*this, part);
+
+    const uint32_t blackAvailable = (MIDDLE_ROWS | ROW_7) & ~whiteMen;
+    men += (rankSet(whiteMen & ROW_0, ROW_0) * choose(24, this->whiteMen - onRow0) + rankSet(whiteMen & MIDDLE_ROWS, MIDDLE_ROWS))
+        * choose(28 - (this->whiteMen - onRow0), this->blackMen)
+        + rankSet(blackMen, blackAvailable);
+
+    const uint32_t free = ~(whiteMen | blackMen), whiteKings = board.white & board.kings;
+    const uint64_t kings = rankSet(whiteKings, free) * choose(Board::SQUARES - this->whiteMen - this->blackMen - this->whiteKings, this->blackKings)
+        + rankSet(board.black & board.kings, free & ~whiteKings);
+
+    return (static_cast<uint64_t>(board.side) * menCount(*this) + men) * kingCount(*this) + kings;
+}
+
+Board Material::board(uint64_t index) const {
+    const uint64_t kingPositions = kingCount(*this), menPositions = menCount(*this);
+    uint64_t kings = index % kingPositions, men = index / kingPositions % menPositions;
+
+    Board board{0, 0, 0, index / kingPositions / menPositions == 0 ? Board::WHITE : Board::BLACK};
+
+    int onRow0 = 0;
+    while (men >= menPart(*this, onRow0)) {
+        men -= menPart(*this, onRow0);
+        onRow0++;
+    }
+
+    const int rest = whiteMen - onRow0;
+    const uint64_t blackPlacements = choose(28 - rest, blackMen), middlePlacements = choose(24, rest);
+    board.white = unrankSet(men / blackPlacements / middlePlacements, onRow0, ROW_0)
+        | unrankSet(men / blackPlacements % middlePlacements, rest, MIDDLE_ROWS);
+    board.black = unrankSet(men % blackPlacements, blackMen, (MIDDLE_ROWS | ROW_7) & ~board.white);
+
+    const uint32_t free = ~(board.white | board.black);
+    const uint64_t blackKingPlacements = choose(Board::SQUARES - whiteMen - blackMen - whiteKings, blackKings);
+    const uint32_t whiteKingSquares = unrankSet(kings / blackKingPlacements, whiteKings, free);
+    const uint32_t blackKingSquares = unrankSet(kings % blackKingPlacements, blackKings, free & ~whiteKingSquares);
+
+    board.white |= whiteKingSquares;
+    board.black |= blackKingSquares;
+    board.kings = whiteKingSquares | blackKingSquares;
+    return board;
+}
+
+Material Material::of(const Board& board) {
+    return Material{
+        __builtin_popcount(board.white & ~board.kings),
+        __builtin_popcount(board.white & board.kings),
+        __builtin_popcount(board.black & ~board.kings),
+        __builtin_popcount(board.black & board.kings)
+    };
+}
+
+std::vector<Material> Material::upTo(int pieces) {
+    std::vector<Material> materials;
+    for (int whiteMen = 0; whiteMen < pieces; whiteMen++) {
+        for (int whiteKings = 0; whiteMen + whiteKings < pieces; whiteKings++) {
+            for (int blackMen = 0; whiteMen + whiteKings + blackMen <= pieces; blackMen++) {
+                for (int blackKings = 0; whiteMen + whiteKings + blackMen + blackKings <= pieces; blackKings++) {
+                    if (whiteMen + whiteKings > 0 && blackMen + blackKings > 0)
+                        materials.push_back(Material{whiteMen, whiteKings, blackMen, blackKings});
+                }
+            }
+        }
+    }
+
+    // captures lower the number of pieces and crownings the number of men
+    std::stable_sort(materials.begin(), materials.end(), [](const Material& a, const Material& b) {
+        if (a.pieces() != b.pieces()) return a.pieces() < b.pieces();
+        return a.whiteMen + a.blackMen < b.whiteMen + b.blackMen;
+    });
+    return materials;
+}
+
+uint8_t encodeValue(Outcome outcome, int distance) {
+    assert(distance <= TABLEBASE_MAX_DISTANCE && (outcome == DRAW || (distance % 2 == 1) == (outcome == WIN)));
+    return outcome == DRAW ? 0 : static_cast<uint8_t>(distance + 1);
+}
+
+Outcome decodeValue(uint8_t value, int& distance) {
+    distance = value - 1;
+    if (value == 0) return DRAW;
+    return distance % 2 == 1 ? WIN : LOSS;
+}
@@ -0,0 +1,68 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Board.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// what a tablebase entry says about the side to move
+enum Outcome {
+    DRAW = 0,
+    WIN = 1,
+    LOSS = 2
+};
+
+// a file is a header padded to 64 KiB followed by one byte per position, 0 for a draw and otherwise the number
+// of plies to the end of the game plus one, odd distances are wins for the side to move and even ones losses;
+// the padding keeps the entries aligned for mmap on pages of up to 64 KiB
+struct TablebaseHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t material[4];
+    uint64_t entries;
+};
+
+static const char TABLEBASE_MAGIC[4] = {'J', 'T', 'B', 'L'};
+static const uint32_t TABLEBASE_VERSION = 2;
+static const int TABLEBASE_HEADER_BYTES = 1 << 16;
+static const int TABLEBASE_MAX_DISTANCE = 254;
+
+// the pieces of each kind on the board, a table holds every position with exactly this material and either side to move
+struct Material {
+    int whiteMen, whiteKings, blackMen, blackKings;
+
+    int pieces() const;
+    int key() const;
+    std::string fileName() const;
+
+    // the number of positions, which are indexed densely by ranking the squares of each kind of piece in turn
+    uint64_t size() const;
+    uint64_t index(const Board& board) const;
+    Board board(uint64_t index) const;
+
+    static Material of(const Board& board);
+    // every material with both sides on the board and at most the given pieces, in an order where the tables
+    // a capture or a crowning leads to come before the table it leads from
+    static std::vector<Material> upTo(int pieces);
+};
+
+uint8_t encodeValue(Outcome outcome, int distance);
+Outcome decodeValue(uint8_t value, int& distance);
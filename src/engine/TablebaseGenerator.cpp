@@ -0,0 +1,238 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TablebaseGenerator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+// runs the function over the whole index range split into one slice per thread
+template <typename F>
+static void parallel(int threads, uint64_t size, F&& function) {
+    std::vector<std::thread> workers;
+    const uint64_t slice = (size + threads - 1) / threads;
+
+    for (int thread = 0; thread < threads; thread++) {
+        const uint64_t first = thread * slice, last = std::min(size, first + slice);
+        if (first < last)
+            workers.emplace_back([&function, thread, first, last]() { function(thread, first, last); });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+// appends what every thread collected and empties the threads' lists
+static void gather(std::vector<uint64_t>& into, std::vector<std::vector<uint64_t>>& lists) {
+    for (auto& list : lists) {
+        into.insert(into.end(), list.begin(), list.end());
+        list.clear();
+    }
+}
+
+TablebaseGenerator::TablebaseGenerator(int threads) : mTables(), mThreads(std::max(threads, 1)) {}
+
+// a first pass looks at every move once: moves that capture or crown leave the table and their values are known
+// already, the moves staying in it are only counted; after that the positions settled with distance d - 1 are
+// taken back a move at a time, a loss makes its predecessors wins in d and a win counts down the moves its predecessors
+// have left open, which is a loss in d once none are left, or later if a move out of the table lasts longer;
+// what's never settled is a draw
+TablebaseGenerator::Result TablebaseGenerator::solve(const Material& material) {
+    const uint64_t size = material.size();
+    auto values = new std::atomic<uint8_t>[size];
+    auto remaining = new std::atomic<uint8_t>[size];
+    // the best a move out of the table gives: a win in its distance, a loss in the longest distance or 0 for a draw
+    auto leaving = new uint8_t[size];
+
+    const auto value = [&](const Board& board) -> uint8_t {
+        if ((board.side == Board::WHITE ? board.white : board.black) == 0) return encodeValue(LOSS, 0);
+
+        const Material next = Material::of(board);
+        const auto table = mTables.find(next.key());
+        assert(table != mTables.end());
+        return table->second[next.index(board)];
+    };
+
+    // positions waiting for the round their distance comes up in and the ones settled in the last round, the threads
+    // collect what they settle and what has to wait in lists of their own
+    std::vector<std::vector<uint64_t>> due(TABLEBASE_MAX_DISTANCE + 1), collected(mThreads), later(mThreads);
+    std::vector<uint64_t> settled;
+
+    const auto schedule = [&]() {
+        for (auto& list : later) {
+            for (const uint64_t i : list) {
+                int distance;
+                decodeValue(leaving[i], distance);
+                due[distance].push_back(i);
+            }
+            list.clear();
+        }
+    };
+
+    parallel(mThreads, size, [&](int thread, uint64_t first, uint64_t last) {
+        for (uint64_t i = first; i < last; i++) {
+            const Board board = material.board(i);
+            MoveList list;
+            board.moves(list);
+
+            int staying = 0, win = -1, loss = 0;
+            bool draw = false;
+            for (int n = 0; n < list.count; n++) {
+                const Board next = board.played(list.moves[n]);
+                if (Material::of(next).key() == material.key()) {
+                    staying++;
+                    continue;
+                }
+
+                int distance;
+                const Outcome outcome = decodeValue(value(next), distance);
+                if (outcome == LOSS) win = win < 0 ? distance + 1 : std::min(win, distance + 1);
+                else if (outcome == WIN) loss = std::max(loss, distance + 1);
+                else draw = true;
+            }
+
+            assert(win <= TABLEBASE_MAX_DISTANCE && loss <= TABLEBASE_MAX_DISTANCE);
+            leaving[i] = win >= 0 ? encodeValue(WIN, win) : draw ? 0 : encodeValue(LOSS, loss);
+            remaining[i].store(staying, std::memory_order_relaxed);
+            values[i].store(0, std::memory_order_relaxed);
+
+            if (list.count == 0) {
+                values[i].store(encodeValue(LOSS, 0), std::memory_order_relaxed);
+                collected[thread].push_back(i);
+            } else if (leaving[i] != 0 && (win >= 0 || staying == 0)) {
+                later[thread].push_back(i);
+            }
+        }
+    });
+
+    gather(settled, collected);
+    schedule();
+
+    Result result{0, 0, 0, 1};
+
+    for (int round = 1; round <= TABLEBASE_MAX_DISTANCE; round++) {
+        // a later round can still be due from a move out of the table even when the last round settled nothing
+        bool pending = !settled.empty();
+        for (int r = round; r <= TABLEBASE_MAX_DISTANCE && !pending; r++)
+            pending = !due[r].empty();
+        if (!pending) break;
+
+        for (const uint64_t i : due[round]) {
+            uint8_t expected = 0;
+            if (values[i].compare_exchange_strong(expected, leaving[i], std::memory_order_relaxed))
+                collected[0].push_back(i);
+        }
+        due[round].clear();
+
+        parallel(mThreads, settled.size(), [&](int thread, uint64_t first, uint64_t last) {
+            for (uint64_t s = first; s < last; s++) {
+                const Board board = material.board(settled[s]);
+                int distance;
+                const bool lost = decodeValue(values[settled[s]].load(std::memory_order_relaxed), distance) == LOSS;
+
+                MoveList list;
+                board.retractions(list);
+                for (int n = 0; n < list.count; n++) {
+                    const Board previous = board.retracted(list.moves[n]);
+                    const uint64_t p = material.index(previous);
+                    if (values[p].load(std::memory_order_relaxed) != 0) continue;
+
+                    // a step can't have been played where the side had a capture
+                    MoveList moves;
+                    previous.moves(moves);
+                    if (moves.moves[0].captured != 0) continue;
+
+                    uint8_t expected = 0;
+                    if (lost) {
+                        if (values[p].compare_exchange_strong(expected, encodeValue(WIN, round), std::memory_order_relaxed))
+                            collected[thread].push_back(p);
+                    } else if (remaining[p].fetch_sub(1, std::memory_order_relaxed) == 1 && leaving[p] != 0) {
+                        // every move staying in the table loses, the position does too unless a move out of it wins
+                        int longest;
+                        if (decodeValue(leaving[p], longest) == WIN) continue;
+                        if (longest > round)
+                            later[thread].push_back(p);
+                        else if (values[p].compare_exchange_strong(expected, encodeValue(LOSS, round), std::memory_order_relaxed))
+                            collected[thread].push_back(p);
+                    }
+                }
+            }
+        });
+
+        settled.clear();
+        gather(settled, collected);
+        schedule();
+
+        if (!settled.empty())
+            result.rounds = round + 1;
+    }
+
+    std::vector<uint8_t> table(size);
+    for (uint64_t i = 0; i < size; i++) {
+        table[i] = values[i].load(std::memory_order_relaxed);
+
+        int distance;
+        const Outcome outcome = decodeValue(table[i], distance);
+        if (outcome == WIN) result.wins++;
+        else if (outcome == LOSS) result.losses++;
+        else result.draws++;
+    }
+    delete[] values;
+    delete[] remaining;
+    delete[] leaving;
+
+    mTables[material.key()] = std::move(table);
+    return result;
+}
+
+// written under a temporary name first so a reader never maps half a table
+bool TablebaseGenerator::write(const Material& material, const std::string& directory) const {
+    const auto table = mTables.find(material.key());
+    if (table == mTables.end()) return false;
+
+    TablebaseHeader header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, TABLEBASE_MAGIC, sizeof TABLEBASE_MAGIC);
+    header.version = TABLEBASE_VERSION;
+    header.material[0] = material.whiteMen;
+    header.material[1] = material.whiteKings;
+    header.material[2] = material.blackMen;
+    header.material[3] = material.blackKings;
+    header.entries = table->second.size();
+
+    std::vector<char> page(TABLEBASE_HEADER_BYTES);
+    memcpy(page.data(), &header, sizeof header);
+
+    const std::string path = directory + "/" + material.fileName(), temporaryPath = path + ".part";
+    const int file = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file < 0) return false;
+
+    const bool written = ::write(file, page.data(), page.size()) == static_cast<ssize_t>(page.size())
+        && ::write(file, table->second.data(), table->second.size()) == static_cast<ssize_t>(table->second.size());
+    close(file);
+
+    if (!written || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        unlink(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
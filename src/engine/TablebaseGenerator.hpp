@@ -0,0 +1,48 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "TablebaseFormat.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// solves tables by retrograde analysis, keeping the solved ones in memory as the later ones look into them
+class TablebaseGenerator final {
+public:
+    struct Result {
+        uint64_t wins, losses, draws;
+        int rounds;
+    };
+private:
+    std::unordered_map<int, std::vector<uint8_t>> mTables;
+    int mThreads;
+public:
+    explicit TablebaseGenerator(int threads);
+    TablebaseGenerator(const TablebaseGenerator&) = delete;
+    TablebaseGenerator(TablebaseGenerator&&) = delete;
+
+    TablebaseGenerator& operator =(const TablebaseGenerator&) = delete;
+    TablebaseGenerator& operator =(TablebaseGenerator&&) = delete;
+
+    // the tables a capture or a crowning leads to have to be solved already, Material::upTo gives that order
+    Result solve(const Material& material);
+    bool write(const Material& material, const std::string& directory) const;
+};
@@ -0,0 +1,94 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TranspositionTable.hpp"
+#include <cassert>
+
+// score 16 bits, depth 8, bound 2, move 8, generation 8
+static inline uint64_t pack(int score, int depth, int bound, int move, unsigned generation) {
+    return static_cast<uint64_t>(static_cast<uint16_t>(score))
+        | static_cast<uint64_t>(depth & 0xff) << 16
+        | static_cast<uint64_t>(bound) << 24
+        | static_cast<uint64_t>(move & 0xff) << 26
+        | static_cast<uint64_t>(generation & 0xff) << 34;
+}
+
+static inline int depthOf(uint64_t data) {
+    return static_cast<int>(data >> 16 & 0xff);
+}
+
+static inline unsigned generationOf(uint64_t data) {
+    return static_cast<unsigned>(data >> 34 & 0xff);
+}
+
+// rounded down to a power of two number of slots
+TranspositionTable::TranspositionTable(int megabytes) : mGeneration(0) {
+    assert(megabytes > 0);
+
+    uint64_t slots = 1;
+    while (slots * 2 * sizeof(Slot) <= static_cast<uint64_t>(megabytes) << 20)
+        slots *= 2;
+
+    mSlots = new Slot[slots];
+    mMask = slots - 1;
+    clear();
+}
+
+TranspositionTable::~TranspositionTable() {
+    delete[] mSlots;
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry& entry) {
+    const Slot& slot = mSlots[key & mMask];
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if ((slot.check.load(std::memory_order_relaxed) ^ data) != key) return false;
+
+    entry.score = static_cast<int16_t>(data & 0xffff);
+    entry.depth = depthOf(data);
+    entry.bound = static_cast<Bound>(data >> 24 & 3);
+    entry.move = static_cast<int>(data >> 26 & 0xff);
+    return true;
+}
+
+// an older or a shallower entry of another position gives way, the same position is always refreshed
+void TranspositionTable::store(uint64_t key, int score, int depth, Bound bound, int move) {
+    assert(depth >= 0 && depth < 256 && move >= 0 && move <= NO_MOVE);
+
+    Slot& slot = mSlots[key & mMask];
+    const unsigned generation = mGeneration.load(std::memory_order_relaxed);
+    const uint64_t old = slot.data.load(std::memory_order_relaxed);
+    const bool same = (slot.check.load(std::memory_order_relaxed) ^ old) == key;
+
+    if (!same && generationOf(old) == (generation & 0xff) && depthOf(old) > depth) return;
+
+    const uint64_t data = pack(score, depth, bound, move, generation);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::nextGeneration() {
+    mGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (uint64_t i = 0; i <= mMask; i++) {
+        // an empty slot only matches a key of all ones, which no position realistically hashes to
+        mSlots[i].check.store(~0ull, std::memory_order_relaxed);
+        mSlots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
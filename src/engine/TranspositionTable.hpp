@@ -0,0 +1,63 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// shared by all the search threads without locks, an entry keeps its key xored with its data
+// so a slot torn by two threads writing at once no longer matches either key and reads as a miss
+class TranspositionTable final {
+public:
+    enum Bound {
+        EXACT = 0,
+        LOWER = 1,
+        UPPER = 2
+    };
+
+    struct Entry {
+        int score, depth, move;
+        Bound bound;
+    };
+
+    static const int NO_MOVE = 255;
+private:
+    struct Slot {
+        std::atomic<uint64_t> check, data;
+    };
+
+    Slot* mSlots;
+    uint64_t mMask;
+    std::atomic<unsigned> mGeneration;
+public:
+    explicit TranspositionTable(int megabytes);
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable(TranspositionTable&&) = delete;
+
+    ~TranspositionTable();
+
+    TranspositionTable& operator =(const TranspositionTable&) = delete;
+    TranspositionTable& operator =(TranspositionTable&&) = delete;
+
+    bool probe(uint64_t key, Entry& entry);
+    void store(uint64_t key, int score, int depth, Bound bound, int move);
+    // entries from earlier searches are replaced before those of the current one
+    void nextGeneration();
+    void clear();
+};
@@ -0,0 +1,128 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int threads) :
+    mWorkers(),
+    mQueues(new Queue[std::max(threads, 1)]),
+    mCount(std::max(threads, 1)),
+    mNext(0),
+    mUnfinished(0),
+    mSleeping(0),
+    mMutex(),
+    mWake(),
+    mDone(),
+    mStopping(false)
+{
+    for (int i = 0; i < mCount; i++)
+        mWorkers.emplace_back(&WorkStealingPool::work, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+
+    for (auto& worker : mWorkers)
+        worker.join();
+    delete[] mQueues;
+}
+
+// the task is counted as unfinished before any worker can see it, or wait could return while it runs
+void WorkStealingPool::submit(Task task) {
+    mUnfinished.fetch_add(1);
+
+    Queue& queue = mQueues[mNext.fetch_add(1, std::memory_order_relaxed) % mCount];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        queue.size.store(static_cast<int>(queue.tasks.size()));
+    }
+
+    // a worker going to sleep counts itself before it looks at the queues and this looks at the count after
+    // growing a queue, so either the worker sees the task or the task's submitter sees the worker
+    if (mSleeping.load() > 0) {
+        std::lock_guard lock(mMutex);
+        mWake.notify_one();
+    }
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock lock(mMutex);
+    mDone.wait(lock, [this]() { return mUnfinished.load() == 0; });
+}
+
+int WorkStealingPool::size() {
+    return mCount;
+}
+
+void WorkStealingPool::work(int index) {
+    Task task;
+    while (true) {
+        if (take(index, task)) {
+            task(index);
+            task = nullptr;
+
+            if (mUnfinished.fetch_sub(1) == 1) {
+                std::lock_guard lock(mMutex);
+                mDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock lock(mMutex);
+        if (mStopping && !queued()) return;
+
+        mSleeping.fetch_add(1);
+        mWake.wait(lock, [this]() { return mStopping || queued(); });
+        mSleeping.fetch_sub(1);
+    }
+}
+
+// newest first from the own queue, which is still warm in the cache, then oldest first from the others
+bool WorkStealingPool::take(int index, Task& task) {
+    for (int offset = 0; offset < mCount; offset++) {
+        Queue& queue = mQueues[(index + offset) % mCount];
+        if (queue.size.load(std::memory_order_relaxed) == 0) continue;
+
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+
+        if (offset == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queue.size.store(static_cast<int>(queue.tasks.size()));
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::queued() {
+    for (int i = 0; i < mCount; i++) {
+        if (mQueues[i].size.load() > 0) return true;
+    }
+    return false;
+}
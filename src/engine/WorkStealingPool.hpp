@@ -0,0 +1,73 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// every worker takes tasks from the back of its own queue and when that runs dry steals from the front of
+// another's, so long and short tasks even out across the workers; a worker that finds every queue empty
+// sleeps until a task is submitted
+class WorkStealingPool final {
+public:
+    // gets the index of the worker running it, for state kept per worker
+    using Task = std::function<void(int)>;
+private:
+    // the size is kept apart from the deque so idle workers can look for tasks without taking every lock
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::atomic<int> size;
+    };
+
+    std::vector<std::thread> mWorkers;
+    Queue* mQueues;
+    int mCount;
+    std::atomic<unsigned> mNext;
+    // tasks submitted and not finished yet, and workers asleep
+    std::atomic<int> mUnfinished, mSleeping;
+    std::mutex mMutex;
+    std::condition_variable mWake, mDone;
+    bool mStopping;
+public:
+    explicit WorkStealingPool(int threads);
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool(WorkStealingPool&&) = delete;
+
+    // the queued tasks are finished before the workers are joined
+    ~WorkStealingPool();
+
+    WorkStealingPool& operator =(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator =(WorkStealingPool&&) = delete;
+
+    // spread over the queues in turn
+    void submit(Task task);
+    // returns once every task submitted so far has finished
+    void wait();
+    int size();
+private:
+    void work(int index);
+    bool take(int index, Task& task);
+    bool queued();
+};
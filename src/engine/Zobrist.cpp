@@ -0,0 +1,70 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Zobrist.hpp"
+
+// white men, black men, white kings, black kings
+static const int KINDS = 4;
+
+struct Keys {
+    uint64_t squares[KINDS][Board::SQUARES];
+    uint64_t side;
+};
+
+// splitmix64, fixed seed so keys and therefore hash tables are the same from run to run
+static constexpr uint64_t nextRandom(uint64_t& state) {
+    uint64_t value = (state += 0x9e3779b97f4a7c15ull);
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+static constexpr Keys makeKeys() {
+    Keys keys{};
+    uint64_t state = 0x4a65616c6e6f;
+    for (int kind = 0; kind < KINDS; kind++) {
+        for (int square = 0; square < Board::SQUARES; square++)
+            keys.squares[kind][square] = nextRandom(state);
+    }
+    keys.side = nextRandom(state);
+    return keys;
+}
+
+static constexpr Keys KEYS = makeKeys();
+
+static inline uint64_t hashSquares(uint64_t key, int kind, uint32_t squares) {
+    for (; squares != 0; squares &= squares - 1)
+        key ^= KEYS.squares[kind][__builtin_ctz(squares)];
+    return key;
+}
+
+static inline uint64_t hashChanges(uint64_t key, const Board& before, const Board& after) {
+    key = hashSquares(key, 0, (before.white & ~before.kings) ^ (after.white & ~after.kings));
+    key = hashSquares(key, 1, (before.black & ~before.kings) ^ (after.black & ~after.kings));
+    key = hashSquares(key, 2, (before.white & before.kings) ^ (after.white & after.kings));
+    key = hashSquares(key, 3, (before.black & before.kings) ^ (after.black & after.kings));
+    return before.side == after.side ? key : key ^ KEYS.side;
+}
+
+uint64_t zobristKey(const Board& board) {
+    return hashChanges(0, Board{0, 0, 0, Board::WHITE}, board);
+}
+
+uint64_t zobristPlayed(uint64_t key, const Board& before, const Board& after) {
+    return hashChanges(key, before, after);
+}
@@ -19,11 +19,36 @@
 #include "Camera.hpp"
 #include "CompoundShader.hpp"
 #include "Model.hpp"
+#include "InstanceBuffer.hpp"
+#include "FrameUniforms.hpp"
+#include "ShadowMap.hpp"
+#include "FrameScheduler.hpp"
+#include "Profiler.hpp"
+#include "HeadlessContext.hpp"
+#include "Benchmark.hpp"
+#include "Overlay.hpp"
+#include "AssetLoader.hpp"
+#include "ShaderLibrary.hpp"
+#include "Frustum.hpp"
+#include "GlState.hpp"
+#include "OutlinePass.hpp"
+#include "RenderQueue.hpp"
+#include "Stats.hpp"
+#include "Opponent.hpp"
+#include "engine/Board.hpp"
+#include "engine/Search.hpp"
+#include <bit>
 #include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
-#include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 
 enum Chip {
@@ -36,232 +61,699 @@ struct CoordinatePair {
     int i, j;
 };
 
-static const int SHADOW_SIZE = 4096, FIELD_SIZE = 8;
+struct PendingAssets {
+    PendingAsset<std::string> sceneVertex, sceneFragment;
+    PendingAsset<ModelData> tileModel, chipModel, cubeModel;
+};
+
+struct SceneUniforms {
+    Uniform<glm::mat4> model;
+    Uniform<glm::vec3> color;
+    Uniform<int> shadowMap;
+};
+
+static const int FIELD_SIZE = 8;
+static const char* const SCENE_VERTEX = "shaders/sceneVertex.glsl", * const SCENE_FRAGMENT = "shaders/sceneFragment.glsl";
+static const float CHIP_SCALE = 0.45f, OUTLINE_WIDTH = 3.0f; // pixels
+
+// how far a level of detail may deviate from the full mesh, in pixels on screen and in texels of the shadow map
+static const float LOD_PIXEL_ERROR = 1.0f, SHADOW_LOD_TEXEL_ERROR = 2.0f;
+
+// the headless benchmark plays the first legal move at every interval and starts over after a number of plies or a lost game
+static const int BENCHMARK_MOVE_INTERVAL = 30, BENCHMARK_GAME_LENGTH = 40;
+static const int SEARCH_TABLE_MEGABYTES = 64;
+static const int DEFAULT_SHADOW_SIZE = 1024, DEFAULT_SHADOW_DEPTH_BITS = 24;
 
 static int gWidth = 0, gHeight = 0;
+static int gShadowSize = DEFAULT_SHADOW_SIZE, gShadowDepthBits = DEFAULT_SHADOW_DEPTH_BITS;
+static unsigned gTargetFramebuffer = 0;
 static Camera gCamera(glm::vec3(0.9f, 2.1f, 2.9f), glm::vec3(0.0f, 1.0f, 0.0f), -89.7f, -47.3f);
+static RenderQueue gRenderQueue;
+static ShaderLibrary* gShaders;
 static CompoundShader* gObjectShader, * gDepthShader, * gLightShader, * gOutlineShader;
+static int gShadowTaps = 4;
 static Model* gTileModel, * gChipModel, * gCubeModel;
-static unsigned gDepthMapFbo, gDepthMap;
+static AssetLoader* gAssetLoader;
+static PendingAssets* gAssets;
+static VertexLayout gVertexLayout = {POSITION_SNORM16, NORMAL_PACKED};
+static bool gMultiDraw = true;
+static MeshArena* gMeshArena;
+// the camera pass and the shadow pass draw the instances inside their own frustum
+static InstanceBuffer* gTileInstances, * gChipInstances, * gShadowTileInstances, * gShadowChipInstances;
+static int gCulled = 0, gShadowCulled = 0;
+static int gChipLodFirst[Mesh::MAX_LODS + 1] = {};
+static int gShadowLod = 0;
+static unsigned gChipLodRevision = 0;
+static SceneUniforms gObjectUniforms, gLightUniforms, gOutlineUniforms;
+static FrameUniforms* gFrameUniforms;
+static unsigned gCameraRevision = 0;
+static ShadowMap* gShadowMap;
+static OutlinePass* gOutlinePass;
+static Profiler* gProfiler;
+static Overlay* gOverlay;
+static bool gOverlayVisible = false;
 static glm::vec3 gLightPos(-2.0f, 4.0f, -1.0f);
-static Chip gChips[FIELD_SIZE][FIELD_SIZE];
-static CoordinatePair gObjectToOutline = {1, 1};
+// the legal moves are listed once per position, the selection and the outlines only look them up
+static Board gBoard;
+static MoveList gMoves;
+static CoordinatePair gObjectToOutline = {1, 1}, gPicked = {1, 1};
 static bool gSelecting = true;
+// where several capture routes of the picked chip end on the same cell, the one on offer as an index into gMoves
+static int gRoute = -1;
+// the side the computer plays, or -1 when both are played by hand
+static int gComputerSide = Board::WHITE;
+// one core is left for rendering so frames keep their pace while the computer thinks
+static SearchLimits gSearchLimits = {0, 1000, ThreadPool::defaultSize()};
+static Opponent* gOpponent;
+static const char* gTablebaseDirectory = "tablebase";
+static Tablebase* gTablebase;
+static SearchReport gThinking;
+static bool gThinkingValid = false;
+// the positions before each move played, for taking moves back
+static std::vector<Board> gHistory;
+static bool gChipsChanged = true;
+
+static uint32_t cellSquare(CoordinatePair cell) {
+    const int square = Board::square(cell.i, cell.j);
+    return square < 0 ? 0 : 1u << square;
+}
 
-static void init() {
-    gObjectShader = new CompoundShader("shaders/objectVertex.glsl", "shaders/objectFragment.glsl");
-    gObjectShader->use();
-    gObjectShader->setValue("shadowMap", 0);
-
-    gDepthShader = new CompoundShader("shaders/depthVertex.glsl", "shaders/depthFragment.glsl");
-    gLightShader = new CompoundShader("shaders/lightVertex.glsl", "shaders/lightFragment.glsl");
-    gOutlineShader = new CompoundShader("shaders/outlineVertex.glsl", "shaders/outlineFragment.glsl");
-
-    gTileModel = new Model("models/tile/tile.obj");
-    gChipModel = new Model("models/chip/chip.obj");
-    gCubeModel = new Model("models/cube/cube.obj");
-
-    glGenTextures(1, &gDepthMap);
-    glBindTexture(GL_TEXTURE_2D, gDepthMap);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_SIZE, SHADOW_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, (float[4]) {1.0f, 1.0f, 1.0f, 1.0f});
-
-    glGenFramebuffers(1, &gDepthMapFbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, gDepthMapFbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gDepthMap, 0);
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
-    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+static Chip chipAt(int i, int j) {
+    const uint32_t square = cellSquare({i, j});
+    if ((gBoard.white & square) != 0) return Chip::WHITE;
+    return (gBoard.black & square) != 0 ? Chip::BLACK : Chip::NONE;
+}
+
+static glm::mat4 tileMatrix(int i, int j) {
+    auto tileModel = glm::mat4(1.0f);
+    tileModel = glm::translate(tileModel, glm::vec3(static_cast<float>(i) * 2.5f / 10.0f, 0.0f, static_cast<float>(j) * 2.5f / 10.0f));
+    return glm::scale(tileModel, glm::vec3(0.125f));
+}
+
+static void cellBounds(int i, int j, glm::vec3& min, glm::vec3& max) {
+    const glm::vec3 center(static_cast<float>(i) * 2.5f / 10.0f, 0.0f, static_cast<float>(j) * 2.5f / 10.0f);
+    min = center + glm::vec3(-0.125f, -0.0125f, -0.125f);
+    max = center + glm::vec3(0.125f, 0.11f, 0.125f);
+}
+
+// fits the shadow map around the tiles, which only receive shadows, and around the cells holding chips, which also cast them
+static void fitShadow() {
+    glm::vec3 min(INFINITY), max(-INFINITY);
 
     for (int i = 0; i < FIELD_SIZE; i++) {
-        for (int j = 0; j < FIELD_SIZE; j++)
-            gChips[j][i] = Chip::NONE;
-    }
+        for (int j = 0; j < FIELD_SIZE; j++) {
+            glm::vec3 cellMin, cellMax;
+            cellBounds(i, j, cellMin, cellMax);
+            // an empty cell holds just the tile, which is as tall above the board as it is deep below it
+            if (chipAt(i, j) == Chip::NONE) cellMax.y = -cellMin.y;
 
-    for (int i = 0, k = 0; i < FIELD_SIZE; i++) {
-        for (int j = 0; j < 3; j++) {
-            if (k % 2 == 0)
-                gChips[j][i] = Chip::WHITE;
-            k++;
+            min = glm::min(min, cellMin);
+            max = glm::max(max, cellMax);
         }
     }
 
-    for (int i = 0, k = 0; i < FIELD_SIZE; i++) {
-        for (int j = 5; j < FIELD_SIZE; j++) {
-            if ((k + 1) % 2 == 0)
-                gChips[j][i] = Chip::BLACK;
-            k++;
-        }
+    if (!gShadowMap->fit(gLightPos, glm::vec3(0.0f), min, max)) return;
+    gFrameUniforms->setLight(gShadowMap->lightSpaceMatrix(), gLightPos);
+
+    // every chip covers the same area of the orthographic shadow map, so one level fits them all
+    gShadowLod = gChipModel->selectLod(SHADOW_LOD_TEXEL_ERROR * gShadowMap->texelSize() / CHIP_SCALE);
+}
+
+static glm::mat4 chipMatrix(int i, int j, float scale) {
+    auto chipModel = glm::mat4(1.0f);
+    chipModel = glm::translate(chipModel, glm::vec3(0.0f, 0.06f, -0.01f));
+    chipModel = glm::translate(chipModel, glm::vec3(static_cast<float>(i) * 2.5f / 10.0f, 0.0f, static_cast<float>(j) * 2.5f / 10.0f));
+    return glm::scale(chipModel, glm::vec3(scale));
+}
+
+static SceneUniforms resolveUniforms(CompoundShader* shader) {
+    return SceneUniforms{
+        shader->uniform<glm::mat4>("model"),
+        shader->uniform<glm::vec3>("color"),
+        shader->uniform<int>("shadowMap")
+    };
+}
+
+// the variant for the current shadow filter tier, compiled the first time a tier is picked
+static void selectLitShader() {
+    gObjectShader = gShaders->variant(SCENE_VERTEX, SCENE_FRAGMENT, {"INSTANCED", "LIT", "SHADOW_TAPS " + std::to_string(gShadowTaps)});
+    gObjectUniforms = resolveUniforms(gObjectShader);
+
+    gObjectShader->use();
+    gObjectShader->setValue(gObjectUniforms.shadowMap, 0);
+}
+
+// started before the window and the context exist, init takes the results once they do
+static void startLoading() {
+    gAssetLoader = new AssetLoader(ThreadPool::defaultSize());
+    gAssets = new PendingAssets{
+        gAssetLoader->loadShaderSource(SCENE_VERTEX),
+        gAssetLoader->loadShaderSource(SCENE_FRAGMENT),
+        gAssetLoader->loadModel("models/tile/tile.obj"),
+        gAssetLoader->loadModel("models/chip/chip.obj"),
+        gAssetLoader->loadModel("models/cube/cube.obj")
+    };
+}
+
+// the computer thinks on its own turns and ponders on the player's
+static void startOpponent() {
+    gThinkingValid = false;
+    if (gOpponent == nullptr) return;
+
+    if (gMoves.count == 0)
+        gOpponent->cancel();
+    else if (gBoard.side == gComputerSide)
+        gOpponent->think(gBoard, gSearchLimits);
+    else
+        gOpponent->ponder(gBoard, gSearchLimits.threads);
+}
+
+static void startGame() {
+    gBoard = Board::initial();
+    gBoard.moves(gMoves);
+    gHistory.clear();
+    gSelecting = true;
+    gRoute = -1;
+    gChipsChanged = true;
+    startOpponent();
+}
+
+static void init() {
+    gShaders = new ShaderLibrary();
+    gAssetLoader->takeShaderSource(gAssets->sceneVertex, gShaders);
+    gAssetLoader->takeShaderSource(gAssets->sceneFragment, gShaders);
+    gShaders->bindUniformBlock("Frame", FrameUniforms::BINDING);
+
+    selectLitShader();
+    gDepthShader = gShaders->variant(SCENE_VERTEX, SCENE_FRAGMENT, {"INSTANCED", "DEPTH_ONLY"});
+    // the light and the outline are both flat colored, so they share one program
+    gLightShader = gShaders->variant(SCENE_VERTEX, SCENE_FRAGMENT, {});
+    gOutlineShader = gShaders->variant(SCENE_VERTEX, SCENE_FRAGMENT, {});
+
+    gLightUniforms = resolveUniforms(gLightShader);
+    gOutlineUniforms = resolveUniforms(gOutlineShader);
+
+    gFrameUniforms = new FrameUniforms();
+
+    // how large a texture may get only the driver knows, so the size is checked once there's a context
+    int maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    if (gShadowSize <= 0 || gShadowSize > maxTextureSize) {
+        SDL_Log("shadow map size has to be between 1 and %d, using %d", maxTextureSize, DEFAULT_SHADOW_SIZE);
+        gShadowSize = DEFAULT_SHADOW_SIZE;
+    }
+    gShadowMap = new ShadowMap(gShadowSize, gShadowDepthBits, FIELD_SIZE * FIELD_SIZE);
+    gOutlinePass = new OutlinePass();
+    gProfiler = new Profiler();
+    gOverlay = new Overlay();
+
+    gMeshArena = new MeshArena(gVertexLayout, gMultiDraw);
+    SDL_Log("multi draw indirect %s", gMeshArena->multiDrawSupported() ? "on" : "off, drawing with base vertices");
+
+    gTileModel = gAssetLoader->takeModel(gAssets->tileModel, gMeshArena);
+    gChipModel = gAssetLoader->takeModel(gAssets->chipModel, gMeshArena);
+    gCubeModel = gAssetLoader->takeModel(gAssets->cubeModel, gMeshArena);
+
+    gAssetLoader->report();
+    delete gAssets;
+    delete gAssetLoader;
+
+    gTileInstances = new InstanceBuffer();
+    gChipInstances = new InstanceBuffer();
+    gShadowTileInstances = new InstanceBuffer();
+    gShadowChipInstances = new InstanceBuffer();
+
+    if (gComputerSide >= 0) {
+        gTablebase = new Tablebase(gTablebaseDirectory);
+        SDL_Log("endgame tablebase: %d pieces from %s", gTablebase->pieces(), gTablebaseDirectory);
+
+        // wakes the render loop when it sleeps waiting for events
+        gOpponent = new Opponent(SEARCH_TABLE_MEGABYTES, gTablebase, []() {
+            SDL_Event event = {};
+            event.type = SDL_USEREVENT;
+            SDL_PushEvent(&event);
+        });
     }
+    startGame();
+}
+
+// picks the level whose error projects to at most LOD_PIXEL_ERROR pixels at the chip's distance from the camera
+static int chipLod(int i, int j, float scale) {
+    const glm::vec3 center(chipMatrix(i, j, scale)[3]);
+    const float distance = glm::length(center - gCamera.position());
+    const float worldPerPixel = 2.0f * distance * std::tan(glm::radians(gCamera.zoom()) * 0.5f) / static_cast<float>(gHeight);
+
+    return gChipModel->selectLod(LOD_PIXEL_ERROR * worldPerPixel / scale);
+}
+
+static glm::vec3 tileColor(int i, int j) {
+    return (i + j) % 2 == 0 ? glm::vec3(0.125f) : glm::vec3(1.0f);
+}
+
+// kings keep their side's brightness with a tint
+static glm::vec3 chipColor(int i, int j) {
+    const bool king = (gBoard.kings & cellSquare({i, j})) != 0;
+    if (chipAt(i, j) == Chip::WHITE)
+        return king ? glm::vec3(1.0f, 0.8f, 0.35f) : glm::vec3(1.0f);
+    return king ? glm::vec3(0.3f, 0.06f, 0.06f) : glm::vec3(0.125f);
 }
 
-static void renderScene(CompoundShader* shader, bool first) {
-    glStencilMask(0x00);
+// fills the buffer with the tiles inside the frustum, marks the chips inside it and returns how many of both were left out
+static int cullCells(const Frustum& frustum, InstanceBuffer* tiles, bool chips[FIELD_SIZE][FIELD_SIZE]) {
+    int culled = 0;
+    tiles->clear();
 
     for (int i = 0; i < FIELD_SIZE; i++) {
         for (int j = 0; j < FIELD_SIZE; j++) {
-            auto tileModel = glm::mat4(1.0f);
-            tileModel = glm::translate(tileModel, glm::vec3(static_cast<float>(i) * 2.5f / 10.0f, 0.0f, static_cast<float>(j) * 2.5f / 10.0f));
-            tileModel = glm::scale(tileModel, glm::vec3(0.125f));
-
-            shader->use();
-            shader->setValue("model", tileModel);
-            shader->setValue("objectColor", (i + j) % 2 == 0 ? glm::vec3(0.125f) : glm::vec3(1.0f));
-            gTileModel->draw(shader, glm::vec4(0.5f));
+            if (frustum.intersects(gTileModel->bounds().transformed(tileMatrix(i, j))))
+                tiles->add(tileMatrix(i, j) * gTileModel->decodeMatrix(), tileColor(i, j));
+            else
+                culled++;
+
+            chips[j][i] = false;
+            if (chipAt(i, j) == Chip::NONE) continue;
+
+            if (frustum.intersects(gChipModel->bounds().transformed(chipMatrix(i, j, CHIP_SCALE))))
+                chips[j][i] = true;
+            else
+                culled++;
         }
     }
 
-    if (!first) {
-        glStencilMask(0xff);
-        glStencilFunc(GL_ALWAYS, 1, 0xFF);
-    }
+    tiles->upload();
+    return culled;
+}
 
+// fills the buffers with the tiles and the chips inside the frustum and returns how many were left out
+static int cullInstances(const Frustum& frustum, InstanceBuffer* tiles, InstanceBuffer* chips) {
+    bool visible[FIELD_SIZE][FIELD_SIZE];
+    const int culled = cullCells(frustum, tiles, visible);
+
+    chips->clear();
     for (int i = 0; i < FIELD_SIZE; i++) {
         for (int j = 0; j < FIELD_SIZE; j++) {
-            const Chip chip = gChips[j][i];
+            if (visible[j][i])
+                chips->add(chipMatrix(i, j, CHIP_SCALE) * gChipModel->decodeMatrix(), chipColor(i, j));
+        }
+    }
+    chips->upload();
+    return culled;
+}
 
-            auto chipModel = glm::mat4(1.0f);
-            chipModel = glm::translate(chipModel, glm::vec3(0.0f, 0.06f, -0.01f));
-            chipModel = glm::translate(chipModel, glm::vec3(static_cast<float>(i) * 2.5f / 10.0f, 0.0f, static_cast<float>(j) * 2.5f / 10.0f));
-            chipModel = glm::scale(chipModel, glm::vec3(0.45f));
+// the camera's instances are rebuilt when either the camera or the chips change and the light's only with the chips,
+// the camera's chips are grouped by level of detail, gChipLodFirst holds where each group starts
+static void updateInstances() {
+    if (!gChipsChanged && gChipLodRevision == gCamera.revision()) return;
+    gChipLodRevision = gCamera.revision();
 
-            shader->use();
-            shader->setValue("model", chipModel);
-            shader->setValue("objectColor", chip == Chip::WHITE ? glm::vec3(1.0f) : glm::vec3(0.125f));
+    bool visible[FIELD_SIZE][FIELD_SIZE];
+    gCulled = cullCells(Frustum(gCamera.projectionMatrix() * gCamera.viewMatrix()), gTileInstances, visible);
 
-            if (chip != Chip::NONE)
-                gChipModel->draw(shader, glm::vec4(0.5f));
-        }
+    int lods[FIELD_SIZE][FIELD_SIZE];
+    for (int i = 0; i < FIELD_SIZE; i++) {
+        for (int j = 0; j < FIELD_SIZE; j++)
+            lods[j][i] = visible[j][i] ? chipLod(i, j, CHIP_SCALE) : -1;
     }
 
-    if (!first) {
-        glStencilFunc(GL_NOTEQUAL, 1, 0xff);
-        glStencilMask(0x00);
-        glDisable(GL_DEPTH_TEST);
-    }
+    gChipInstances->clear();
+    for (int lod = 0; lod < Mesh::MAX_LODS; lod++) {
+        gChipLodFirst[lod] = gChipInstances->count();
 
-    if (!first) {
         for (int i = 0; i < FIELD_SIZE; i++) {
             for (int j = 0; j < FIELD_SIZE; j++) {
-                auto chipModel = glm::mat4(1.0f);
-                chipModel = glm::translate(chipModel, glm::vec3(0.0f, 0.06f, -0.01f));
-                chipModel = glm::translate(chipModel, glm::vec3(static_cast<float>(i) * 2.5f / 10.0f, 0.0f, static_cast<float>(j) * 2.5f / 10.0f));
-                chipModel = glm::scale(chipModel, glm::vec3(0.475f));
-
-                gOutlineShader->use();
-                gOutlineShader->setValue("model", chipModel);
-
-                if (i == gObjectToOutline.i && j == gObjectToOutline.j)
-                    gChipModel->draw(gOutlineShader, glm::vec4(0.5f));
+                if (lods[j][i] == lod)
+                    gChipInstances->add(chipMatrix(i, j, CHIP_SCALE) * gChipModel->decodeMatrix(), chipColor(i, j));
             }
         }
     }
+    gChipLodFirst[Mesh::MAX_LODS] = gChipInstances->count();
+    gChipInstances->upload();
 
-    if (!first) {
-        glStencilMask(0xff);
-        glStencilFunc(GL_ALWAYS, 0, 0xff);
-        glEnable(GL_DEPTH_TEST);
-    }
-}
+    if (!gChipsChanged) return;
+    gChipsChanged = false;
 
-static void render() {
-    const glm::mat4 lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 1.0f, 7.5f);
-    const glm::mat4 lightView = glm::lookAt(gLightPos, glm::vec3(0.0f), glm::vec3(0.0, 1.0, 0.0));
-    const glm::mat4 lightSpaceMatrix = lightProjection * lightView;
+    fitShadow();
+    gShadowCulled = cullInstances(Frustum(gShadowMap->lightSpaceMatrix()), gShadowTileInstances, gShadowChipInstances);
 
-    gDepthShader->use();
-    gDepthShader->setValue("lightSpaceMatrix", lightSpaceMatrix);
-    gDepthShader->setValue("model", glm::mat4(1.0f));
+    for (int i = 0; i < FIELD_SIZE; i++) {
+        for (int j = 0; j < FIELD_SIZE; j++) {
+            glm::vec3 min, max;
+            cellBounds(i, j, min, max);
+            gShadowMap->trackCaster(i * FIELD_SIZE + j, chipAt(i, j), min, max);
+        }
+    }
+}
 
-    glViewport(0, 0, SHADOW_SIZE, SHADOW_SIZE);
-    glBindFramebuffer(GL_FRAMEBUFFER, gDepthMapFbo);
-    glClear(GL_DEPTH_BUFFER_BIT);
+static RenderQueue::Packet instancedPacket(RenderQueue::Pass pass, RenderQueue::State state, CompoundShader* shader, InstanceBuffer* instances, int lod, int first, int count) {
+    return RenderQueue::Packet{pass, state, shader, nullptr, lod, instances, first, count, {}, glm::mat4(1.0f), {}, glm::vec3(0.0f)};
+}
 
-    renderScene(gDepthShader, true);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+static RenderQueue::Packet placedPacket(RenderQueue::Pass pass, RenderQueue::State state, CompoundShader* shader, const SceneUniforms& uniforms, const glm::mat4& model, const glm::vec3& color, int lod) {
+    return RenderQueue::Packet{pass, state, shader, nullptr, lod, nullptr, 0, 0, uniforms.model, model, uniforms.color, color};
+}
 
-    glViewport(0, 0, gWidth, gHeight);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+// the shadow pass draws every chip at the shadow map's level, the scene pass groups them by their own levels
+static void submitScene(CompoundShader* shader, bool first) {
+    InstanceBuffer* tiles = first ? gShadowTileInstances : gTileInstances, * chips = first ? gShadowChipInstances : gChipInstances;
+    gStats.count(Stats::INSTANCES_SUBMITTED, tiles->count() + chips->count());
+    gStats.count(Stats::INSTANCES_CULLED, first ? gShadowCulled : gCulled);
 
-    const glm::mat4 projection = glm::perspective(glm::radians(gCamera.zoom()), static_cast<float>(gWidth) / static_cast<float>(gHeight), 0.1f, 100.0f);
-    const glm::mat4 view = gCamera.viewMatrix();
+    const RenderQueue::Pass pass = first ? RenderQueue::SHADOW : RenderQueue::SCENE;
+    gTileModel->submit(&gRenderQueue, instancedPacket(pass, RenderQueue::OPAQUE, shader, tiles, 0, 0, tiles->count()));
 
-    gObjectShader->use();
-    gObjectShader->setValue("projection", projection);
-    gObjectShader->setValue("view", view);
-    gObjectShader->setValue("viewPos", gCamera.position());
-    gObjectShader->setValue("lightPos", gLightPos);
-    gObjectShader->setValue("lightSpaceMatrix", lightSpaceMatrix);
+    if (first) {
+        gChipModel->submit(&gRenderQueue, instancedPacket(pass, RenderQueue::OPAQUE, shader, chips, gShadowLod, 0, chips->count()));
+        return;
+    }
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gDepthMap);
+    for (int lod = 0; lod < Mesh::MAX_LODS; lod++)
+        gChipModel->submit(&gRenderQueue, instancedPacket(pass, RenderQueue::OPAQUE, shader, chips, lod, gChipLodFirst[lod], gChipLodFirst[lod + 1] - gChipLodFirst[lod]));
+}
 
-    gOutlineShader->use();
-    gOutlineShader->setValue("projection", projection);
-    gOutlineShader->setValue("view", view);
-    gOutlineShader->setValue("color", gSelecting ? glm::vec3(1.0f) : glm::vec3(1.0f, 0.1f, 0.1f));
+// draws the cell into the outline mask, its chip if it has one or its tile otherwise
+static void submitOutline(CoordinatePair cell, const glm::vec3& color) {
+    if (chipAt(cell.i, cell.j) == Chip::NONE) {
+        gTileModel->submit(&gRenderQueue, placedPacket(
+            RenderQueue::OUTLINE,
+            RenderQueue::UNTESTED,
+            gOutlineShader,
+            gOutlineUniforms,
+            tileMatrix(cell.i, cell.j) * gTileModel->decodeMatrix(),
+            color,
+            0
+        ));
+        return;
+    }
 
-    renderScene(gObjectShader, false);
+    gChipModel->submit(&gRenderQueue, placedPacket(
+        RenderQueue::OUTLINE,
+        RenderQueue::UNTESTED,
+        gOutlineShader,
+        gOutlineUniforms,
+        chipMatrix(cell.i, cell.j, CHIP_SCALE) * gChipModel->decodeMatrix(),
+        color,
+        chipLod(cell.i, cell.j, CHIP_SCALE)
+    ));
+}
 
+static void submitLight() {
     auto lightModelMatrix = glm::mat4(1.0f);
     lightModelMatrix = glm::translate(lightModelMatrix, gLightPos);
     lightModelMatrix = glm::scale(lightModelMatrix, glm::vec3(0.25f));
 
-    gLightShader->use();
-    gLightShader->setValue("projection", projection);
-    gLightShader->setValue("view", view);
-    gLightShader->setValue("model", lightModelMatrix);
+    gCubeModel->submit(&gRenderQueue, placedPacket(
+        RenderQueue::LIGHT,
+        RenderQueue::OPAQUE,
+        gLightShader,
+        gLightUniforms,
+        lightModelMatrix * gCubeModel->decodeMatrix(),
+        glm::vec3(1.0f),
+        0
+    ));
+}
+
+static void render() {
+    gCamera.setAspect(static_cast<float>(gWidth) / static_cast<float>(gHeight));
+    if (gCamera.revision() != gCameraRevision) {
+        gCameraRevision = gCamera.revision();
+        gFrameUniforms->setCamera(gCamera.projectionMatrix(), gCamera.viewMatrix(), gCamera.position());
+    }
+
+    updateInstances();
+
+    if (gShadowMap->begin()) {
+        gProfiler->begin(Profiler::SHADOW);
+        submitScene(gDepthShader, true);
+        gRenderQueue.flush();
+        gProfiler->end(Profiler::SHADOW);
+        gShadowMap->end();
+    }
 
-    gCubeModel->draw(gLightShader, glm::vec4(1.0f));
+    glBindFramebuffer(GL_FRAMEBUFFER, gTargetFramebuffer);
+    glViewport(0, 0, gWidth, gHeight);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    SDL_Delay(1000 / 60);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, gShadowMap->texture());
+
+    // flushed pass by pass so the profiler can time each of them
+    gProfiler->begin(Profiler::SCENE);
+    submitScene(gObjectShader, false);
+    gRenderQueue.flush();
+    gProfiler->end(Profiler::SCENE);
+
+    // any number of cells can go into the mask at the same cost
+    gProfiler->begin(Profiler::OUTLINE);
+    gOutlinePass->beginMask(gWidth, gHeight);
+    if (!gSelecting) {
+        for (int i = 0; i < gMoves.count; i++) {
+            if (gMoves.moves[i].from != cellSquare(gPicked) || (gRoute >= 0 && i != gRoute)) continue;
+
+            CoordinatePair destination;
+            Board::cell(std::countr_zero(gMoves.moves[i].to), destination.i, destination.j);
+            submitOutline(destination, glm::vec3(0.1f, 1.0f, 0.1f));
+        }
+
+        // the route on offer shows which chips it takes
+        for (uint32_t captured = gRoute >= 0 ? gMoves.moves[gRoute].captured : 0; captured != 0; captured &= captured - 1) {
+            CoordinatePair cell;
+            Board::cell(std::countr_zero(captured), cell.i, cell.j);
+            submitOutline(cell, glm::vec3(1.0f, 0.8f, 0.1f));
+        }
+        submitOutline(gPicked, glm::vec3(1.0f, 0.1f, 0.1f));
+    }
+    // the cursor goes last so it stays on top of the others where they overlap
+    submitOutline(gObjectToOutline, glm::vec3(1.0f));
+    gRenderQueue.flush();
+    gOutlinePass->composite(gTargetFramebuffer, OUTLINE_WIDTH);
+    gProfiler->end(Profiler::OUTLINE);
+
+    gProfiler->begin(Profiler::LIGHT);
+    submitLight();
+    gRenderQueue.flush();
+    gProfiler->end(Profiler::LIGHT);
+    gProfiler->endFrame();
 }
 
 static void clean() {
-    delete gObjectShader;
-    delete gDepthShader;
-    delete gLightShader;
-    delete gOutlineShader;
+    delete gShaders;
 
     delete gTileModel;
     delete gChipModel;
     delete gCubeModel;
+    delete gMeshArena;
+
+    delete gTileInstances;
+    delete gChipInstances;
+    delete gShadowTileInstances;
+    delete gShadowChipInstances;
+
+    delete gFrameUniforms;
+    delete gShadowMap;
+    delete gOutlinePass;
+    delete gProfiler;
+    delete gOverlay;
+    delete gOpponent;
+    delete gTablebase;
+}
 
-    glDeleteTextures(1, &gDepthMap);
+// the side left without a legal move has lost
+static void play(const Move& move) {
+    gHistory.push_back(gBoard);
+    gBoard = gBoard.played(move);
+    gBoard.moves(gMoves);
+    gRoute = -1;
+    gChipsChanged = true;
+
+    if (gMoves.count == 0)
+        SDL_Log("%s wins", gBoard.side == Board::WHITE ? "black" : "white");
+    startOpponent();
+}
+
+// takes back the last move, and when it was the computer's also the player's move before it
+static void undo() {
+    if (gHistory.empty()) return;
+
+    do {
+        gBoard = gHistory.back();
+        gHistory.pop_back();
+    } while (gBoard.side == gComputerSide && !gHistory.empty());
 
-    glDeleteFramebuffers(1, &gDepthMapFbo);
+    gBoard.moves(gMoves);
+    gSelecting = true;
+    gRoute = -1;
+    gChipsChanged = true;
+    startOpponent();
+}
+
+// plays the computer's move once its search is done, returns whether anything changed on screen
+static bool pollOpponent() {
+    SearchReport report;
+    bool final;
+    if (gOpponent == nullptr || !gOpponent->poll(report, final)) return false;
+
+    gThinking = report;
+    gThinkingValid = !final;
+    if (!final) return gOverlayVisible;
+
+    SDL_Log(
+        "depth %d, score %d, %llu nodes in %.2f s (%.0f kN/s), branching factor %.2f",
+        report.depth,
+        report.score,
+        static_cast<unsigned long long>(report.nodes),
+        report.seconds,
+        report.seconds > 0.0 ? static_cast<double>(report.nodes) / report.seconds / 1000.0 : 0.0,
+        report.branching
+    );
+    play(report.move);
+    return true;
 }
 
 static void move(bool check, int i, int j) {
-    if (check) {
-        if (gSelecting)
-            gObjectToOutline = {i, j};
-        else if (gChips[gObjectToOutline.j][gObjectToOutline.i] != Chip::NONE) {
-            gChips[j][i] = gChips[gObjectToOutline.j][gObjectToOutline.i];
-            gChips[gObjectToOutline.j][gObjectToOutline.i] = Chip::NONE;
+    if (check)
+        gObjectToOutline = {i, j};
+}
+
+// picks the chip under the cursor if it can move, then plays it to the cell under the cursor or drops it
+static void confirm() {
+    if (gBoard.side == gComputerSide) return;
+    const uint32_t cursor = cellSquare(gObjectToOutline);
+
+    if (gSelecting) {
+        for (int i = 0; i < gMoves.count; i++) {
+            if (gMoves.moves[i].from != cursor) continue;
+
+            gPicked = gObjectToOutline;
+            gSelecting = false;
+            break;
+        }
+        return;
+    }
+
+    gSelecting = true;
+    if (gRoute >= 0) {
+        const Move route = gMoves.moves[gRoute];
+        gRoute = -1;
+        if (route.to == cursor)
+            play(route);
+        return;
+    }
+
+    // routes that end on the same cell but take other chips are offered one at a time, see nextRoute
+    int first = -1, routes = 0;
+    for (int i = 0; i < gMoves.count; i++) {
+        if (gMoves.moves[i].from == cellSquare(gPicked) && gMoves.moves[i].to == cursor && routes++ == 0)
+            first = i;
+    }
+
+    if (routes == 1) {
+        play(gMoves.moves[first]);
+    } else if (routes > 1) {
+        gRoute = first;
+        gSelecting = false;
+    }
+}
+
+// offers the next of the routes that end where the one on offer does
+static void nextRoute() {
+    if (gRoute < 0) return;
+
+    const Move& route = gMoves.moves[gRoute];
+    for (int step = 1; step < gMoves.count; step++) {
+        const int i = (gRoute + step) % gMoves.count;
+        if (gMoves.moves[i].from == route.from && gMoves.moves[i].to == route.to) {
+            gRoute = i;
+            return;
         }
     }
 }
 
-static void renderLoop(SDL_Window* window) {
+static const char* frameModeName(FrameScheduler::Mode mode) {
+    switch (mode) {
+        case FrameScheduler::ON_DEMAND:
+            return "on-demand";
+        case FrameScheduler::VSYNC:
+            return "vsync";
+        default:
+            return "uncapped";
+    }
+}
+
+static void drawOverlay(FrameScheduler* scheduler) {
+    std::vector<std::string> lines;
+    char line[128];
+
+    snprintf(line, sizeof line, "frame %.2f ms  mode %s", gProfiler->averageFrameTime(), frameModeName(scheduler->mode()));
+    lines.emplace_back(line);
+
+    for (int pass = 0; pass < Profiler::PASS_COUNT; pass++) {
+        snprintf(
+            line,
+            sizeof line,
+            "%-8s cpu %6.3f  gpu %6.3f",
+            Profiler::passName(static_cast<Profiler::Pass>(pass)),
+            gProfiler->averageCpuTime(static_cast<Profiler::Pass>(pass)),
+            gProfiler->averageGpuTime(static_cast<Profiler::Pass>(pass))
+        );
+        lines.emplace_back(line);
+    }
+
+    for (int counter = 0; counter < Stats::COUNTER_COUNT; counter++) {
+        snprintf(line, sizeof line, "%-16s %lu", Stats::counterName(static_cast<Stats::Counter>(counter)), gProfiler->counter(static_cast<Stats::Counter>(counter)));
+        lines.emplace_back(line);
+    }
+
+    snprintf(line, sizeof line, "latency %.1f ms (max %.0f)", scheduler->averageLatency(), scheduler->maxLatency());
+    lines.emplace_back(line);
+
+    if (gThinkingValid) {
+        snprintf(line, sizeof line, "thinking depth %d score %d (%.0f kN/s)", gThinking.depth, gThinking.score, gThinking.seconds > 0.0 ? static_cast<double>(gThinking.nodes) / gThinking.seconds / 1000.0 : 0.0);
+        lines.emplace_back(line);
+    }
+
+    gOverlay->draw(lines, gWidth, gHeight);
+}
+
+static void capturePerformance(FrameScheduler* scheduler) {
+    char header[512];
+    snprintf(
+        header,
+        sizeof header,
+        "renderer: %s\nversion: %s\nresolution: %dx%d, shadow map %d (%d-bit, %d taps), frame mode %s\ninput-to-present latency: %.1f ms average, %.0f ms max\n",
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+        reinterpret_cast<const char*>(glGetString(GL_VERSION)),
+        gWidth,
+        gHeight,
+        gShadowSize,
+        gShadowDepthBits,
+        gShadowTaps,
+        frameModeName(scheduler->mode()),
+        scheduler->averageLatency(),
+        scheduler->maxLatency()
+    );
+
+    if (gProfiler->writeCapture("jealno-performance.log", header))
+        SDL_Log("performance capture appended to jealno-performance.log");
+}
+
+static void renderLoop(SDL_Window* window, FrameScheduler* scheduler) {
     int width, height;
     SDL_Event event;
 
     init();
 
     while (true) {
-        SDL_GL_GetDrawableSize(window, &width, &height);
-        glViewport(0, 0, width, height);
-
-        while (SDL_PollEvent(&event) == 1) {
+        while (scheduler->nextEvent(&event)) {
             switch (event.type) {
                 case SDL_QUIT:
                     goto end;
+                case SDL_WINDOWEVENT:
+                    scheduler->requestRedraw();
+                    break;
+                case SDL_USEREVENT:
+                    if (pollOpponent())
+                        scheduler->requestRedraw();
+                    break;
                 case SDL_KEYDOWN:
                     switch (event.key.keysym.sym) {
                         case SDLK_q:
@@ -277,29 +769,184 @@ static void renderLoop(SDL_Window* window) {
                             move(gObjectToOutline.i > 0 && gObjectToOutline.j < FIELD_SIZE - 1, gObjectToOutline.i - 1, gObjectToOutline.j + 1);
                             break;
                         case SDLK_RETURN:
-                            if (gSelecting && gChips[gObjectToOutline.j][gObjectToOutline.i] != Chip::NONE)
-                                gSelecting = false;
-                            else
-                                gSelecting = true;
+                            confirm();
+                            break;
+                        case SDLK_TAB:
+                            nextRoute();
+                            break;
+                        case SDLK_u:
+                            undo();
                             break;
+                        case SDLK_r:
+                            startGame();
+                            break;
+                        case SDLK_m:
+                            scheduler->setMode(static_cast<FrameScheduler::Mode>((scheduler->mode() + 1) % 3));
+                            continue;
+                        case SDLK_p:
+                            gShadowTaps = gShadowTaps == 16 ? 1 : gShadowTaps * 4;
+                            selectLitShader();
+                            break;
+                        case SDLK_F3:
+                            gOverlayVisible = !gOverlayVisible;
+                            break;
+                        case SDLK_F12:
+                            capturePerformance(scheduler);
+                            continue;
+                        default:
+                            continue;
                     }
+                    scheduler->inputHandled(event);
                     break;
             }
         }
 
+        // the search runs on its own threads, the loop only picks up what it found, also where it didn't sleep for the wake up
+        if (pollOpponent())
+            scheduler->requestRedraw();
+
+        SDL_GL_GetDrawableSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         render();
+        if (gOverlayVisible)
+            drawOverlay(scheduler);
 
         SDL_GL_SwapWindow(window);
+        scheduler->presented();
     }
     end:
 
+    SDL_Log("input-to-present latency: %.1f ms average, %.0f ms max", scheduler->averageLatency(), scheduler->maxLatency());
+
+    clean();
+}
+
+static int runHeadless(int frames, const char* output) {
+    gWidth = 16 * 100;
+    gHeight = 9 * 100;
+
+    auto context = new HeadlessContext(gWidth, gHeight);
+    gTargetFramebuffer = context->framebuffer();
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glEnable(GL_CULL_FACE);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // the benchmark plays both sides itself
+    gComputerSide = -1;
+    init();
+
+    auto benchmark = new Benchmark(frames);
+    int plies = 0;
+
+    for (int frame = 0; frame < frames; frame++) {
+        if (frame > 0 && frame % BENCHMARK_MOVE_INTERVAL == 0) {
+            if (gMoves.count == 0 || plies == BENCHMARK_GAME_LENGTH) {
+                startGame();
+                plies = 0;
+            } else {
+                play(gMoves.moves[0]);
+                plies++;
+            }
+        }
+
+        const Uint64 start = SDL_GetPerformanceCounter();
+
+        glBindFramebuffer(GL_FRAMEBUFFER, gTargetFramebuffer);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        render();
+        glFinish();
+
+        benchmark->record(static_cast<float>(SDL_GetPerformanceCounter() - start) * 1000.0f / static_cast<float>(SDL_GetPerformanceFrequency()), gProfiler);
+    }
+
+    const bool written = benchmark->write(output, reinterpret_cast<const char*>(glGetString(GL_RENDERER)), gWidth, gHeight);
+    if (!written)
+        SDL_Log("unable to write %s", output);
+
+    delete benchmark;
     clean();
+    delete context;
+
+    return written ? 0 : 1;
 }
 
-int main() {
+// the whole text as a non-negative number, -1 when it isn't one so the range checks reject it
+static int parseCount(const char* text) {
+    char* end;
+    const long value = strtol(text, &end, 10);
+    return end == text || *end != '\0' || value < 0 || value > INT_MAX ? -1 : static_cast<int>(value);
+}
+
+int main(int argc, char** argv) {
+    auto frameMode = FrameScheduler::ON_DEMAND;
+    bool headless = false;
+    int frames = 600;
+    const char* output = "benchmark.json";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--vsync") == 0)
+            frameMode = FrameScheduler::VSYNC;
+        else if (strcmp(argv[i], "--uncapped") == 0)
+            frameMode = FrameScheduler::UNCAPPED;
+        else if (strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (strncmp(argv[i], "--frames=", 9) == 0)
+            frames = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--output=", 9) == 0)
+            output = argv[i] + 9;
+        else if (strcmp(argv[i], "--positions=float") == 0)
+            gVertexLayout = {POSITION_FLOAT, NORMAL_FLOAT};
+        else if (strcmp(argv[i], "--positions=half") == 0)
+            gVertexLayout.position = POSITION_HALF;
+        else if (strcmp(argv[i], "--no-multi-draw") == 0)
+            gMultiDraw = false;
+        else if (strncmp(argv[i], "--shadow-size=", 14) == 0)
+            gShadowSize = parseCount(argv[i] + 14);
+        else if (strncmp(argv[i], "--shadow-depth=", 15) == 0)
+            gShadowDepthBits = parseCount(argv[i] + 15);
+        else if (strcmp(argv[i], "--shadow-taps=1") == 0)
+            gShadowTaps = 1;
+        else if (strcmp(argv[i], "--shadow-taps=16") == 0)
+            gShadowTaps = 16;
+        else if (strcmp(argv[i], "--computer=white") == 0)
+            gComputerSide = Board::WHITE;
+        else if (strcmp(argv[i], "--computer=black") == 0)
+            gComputerSide = Board::BLACK;
+        else if (strcmp(argv[i], "--computer=none") == 0)
+            gComputerSide = -1;
+        else if (strncmp(argv[i], "--search-depth=", 15) == 0)
+            gSearchLimits.depth = atoi(argv[i] + 15);
+        else if (strncmp(argv[i], "--search-time=", 14) == 0)
+            gSearchLimits.milliseconds = atoi(argv[i] + 14);
+        else if (strncmp(argv[i], "--search-threads=", 17) == 0)
+            gSearchLimits.threads = atoi(argv[i] + 17);
+        else if (strncmp(argv[i], "--tablebase=", 12) == 0)
+            gTablebaseDirectory = argv[i] + 12;
+    }
+
+    if (gShadowDepthBits != 16 && gShadowDepthBits != 24 && gShadowDepthBits != 32) {
+        SDL_Log("shadow map depth has to be 16, 24 or 32 bits, using %d", DEFAULT_SHADOW_DEPTH_BITS);
+        gShadowDepthBits = DEFAULT_SHADOW_DEPTH_BITS;
+    }
+
+    // a search with neither limit would never end
+    if (gSearchLimits.depth <= 0 && gSearchLimits.milliseconds <= 0)
+        gSearchLimits.milliseconds = 1000;
+
+    startLoading();
+
+    if (headless)
+        return runHeadless(frames, output);
+
     assert(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_TIMER) == 0);
 
     SDL_version version;
@@ -311,7 +958,6 @@ int main() {
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
-    SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
 
     SDL_Window* window = SDL_CreateWindow(
         "Jealno",
@@ -331,16 +977,11 @@ int main() {
     glEnable(GL_MULTISAMPLE);
     glEnable(GL_BLEND);
     glEnable(GL_CULL_FACE);
-    glEnable(GL_STENCIL_TEST);
 
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glStencilFunc(GL_NOTEQUAL, 1, 0xff);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-
-    SDL_GL_SetSwapInterval(1);
-
-    renderLoop(window);
+    FrameScheduler scheduler(frameMode);
+    renderLoop(window, &scheduler);
 
     SDL_GL_DeleteContext(glContext);
     SDL_DestroyWindow(window);
@@ -0,0 +1,55 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "engine/Board.hpp"
+#include "engine/Perft.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// published node counts of English draughts from the initial position, depth 1 first
+static const uint64_t EXPECTED[] = {7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680, 18391564, 85242128, 388623673};
+static const int MAX_DEPTH = sizeof EXPECTED / sizeof *EXPECTED;
+
+int main(int argc, char** argv) {
+    const int depth = argc > 1 ? atoi(argv[1]) : 9;
+    if (depth < 1 || depth > MAX_DEPTH) {
+        fprintf(stderr, "usage: %s [depth 1-%d]\n", argv[0], MAX_DEPTH);
+        return 2;
+    }
+
+    bool passed = true;
+    for (int d = 1; d <= depth; d++) {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t nodes = perft(Board::initial(), d);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const bool correct = nodes == EXPECTED[d - 1];
+        passed = passed && correct;
+        printf(
+            "depth %2d  %12llu nodes  %8.3f s  %8.2f Mpos/s  %s\n",
+            d,
+            static_cast<unsigned long long>(nodes),
+            seconds,
+            seconds > 0.0 ? static_cast<double>(nodes) / seconds / 1e6 : 0.0,
+            correct ? "ok" : "MISMATCH"
+        );
+    }
+
+    return passed ? 0 : 1;
+}
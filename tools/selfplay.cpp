@@ -0,0 +1,285 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "engine/Board.hpp"
+#include "engine/Search.hpp"
+#include "engine/Tablebase.hpp"
+#include "engine/WorkStealingPool.hpp"
+#include "engine/Zobrist.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// a game record is the number of plies (16 bits), the result, the flags and then a byte per ply holding the index
+// of the move among those Board::moves lists, which is all a reader needs to replay it from the initial position
+static const char MAGIC[4] = {'J', 'S', 'P', 'G'};
+static const uint32_t VERSION = 1;
+
+enum Result {
+    DRAWN = 0,
+    BLACK_WON = 1,
+    WHITE_WON = 2
+};
+
+// set when engine A played black
+static const uint8_t FLAG_A_BLACK = 1;
+
+// a game is drawn once a position comes up for the third time or once neither side has moved a man or captured for this long
+static const int REPETITIONS = 3, QUIET_PLIES = 80;
+
+struct Settings {
+    SearchLimits limits;
+    int tableMegabytes;
+    const char* tablebase;
+};
+
+// the engines of each worker, kept from game to game so their tables are allocated once
+struct Players {
+    Search* a, * b;
+};
+
+static bool parseSettings(const char* argument, const char* prefix, Settings& settings) {
+    const size_t length = strlen(prefix);
+    if (strncmp(argument, prefix, length) != 0) return false;
+    argument += length;
+
+    if (strncmp(argument, "depth=", 6) == 0)
+        settings.limits.depth = atoi(argument + 6);
+    else if (strncmp(argument, "time=", 5) == 0)
+        settings.limits.milliseconds = atoi(argument + 5);
+    else if (strncmp(argument, "hash=", 5) == 0)
+        settings.tableMegabytes = atoi(argument + 5);
+    else if (strncmp(argument, "tablebase=", 10) == 0)
+        settings.tablebase = argument + 10;
+    else
+        return false;
+    return true;
+}
+
+static Result playGame(Board board, Search* black, const Settings& blackSettings, Search* white, const Settings& whiteSettings, int maxPlies, std::vector<uint8_t>& moves) {
+    std::vector<uint64_t> keys = {zobristKey(board)};
+    int quiet = 0;
+
+    while (static_cast<int>(moves.size()) < maxPlies) {
+        MoveList list;
+        board.moves(list);
+        if (list.count == 0) return board.side == Board::BLACK ? WHITE_WON : BLACK_WON;
+
+        const bool blackToMove = board.side == Board::BLACK;
+        const SearchReport report = (blackToMove ? black : white)->run(board, (blackToMove ? blackSettings : whiteSettings).limits);
+
+        int index = 0;
+        while (memcmp(&list.moves[index], &report.move, sizeof(Move)) != 0)
+            index++;
+        moves.push_back(static_cast<uint8_t>(index));
+
+        const bool progress = report.move.captured != 0 || (report.move.from & ~board.kings) != 0;
+        board = board.played(report.move);
+
+        // a capture or a man's move can't be undone, so no position before it comes up again
+        if (progress) {
+            keys.clear();
+            quiet = 0;
+        } else if (++quiet == QUIET_PLIES) {
+            return DRAWN;
+        }
+
+        const uint64_t key = zobristKey(board);
+        int seen = 1;
+        for (uint64_t earlier : keys)
+            seen += earlier == key;
+        if (seen == REPETITIONS) return DRAWN;
+        keys.push_back(key);
+    }
+    return DRAWN;
+}
+
+// the score and its 95% interval turned into Elo differences, the interval from the spread of the per game scores
+static void elo(uint64_t wins, uint64_t draws, uint64_t losses, double& difference, double& margin) {
+    const double games = static_cast<double>(wins + draws + losses);
+    const double score = (static_cast<double>(wins) + static_cast<double>(draws) * 0.5) / games;
+    const double variance = (static_cast<double>(wins) * (1.0 - score) * (1.0 - score)
+        + static_cast<double>(draws) * (0.5 - score) * (0.5 - score)
+        + static_cast<double>(losses) * score * score) / games;
+
+    const auto toElo = [](double value) {
+        value = std::clamp(value, 1e-6, 1.0 - 1e-6);
+        return -400.0 * std::log10(1.0 / value - 1.0);
+    };
+
+    const double deviation = std::sqrt(variance / games) * 1.96;
+    difference = toElo(score);
+    margin = (toElo(score + deviation) - toElo(score - deviation)) * 0.5;
+}
+
+int main(int argc, char** argv) {
+    int games = 1000, threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1), openingPlies = 6, maxPlies = 200;
+    unsigned seed = 1;
+    const char* output = "selfplay.bin";
+    Settings a = {{6, 0, 1}, 16, nullptr}, b = {{4, 0, 1}, 16, nullptr};
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--games=", 8) == 0)
+            games = atoi(argv[i] + 8);
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+            threads = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--opening-plies=", 16) == 0)
+            openingPlies = atoi(argv[i] + 16);
+        else if (strncmp(argv[i], "--max-plies=", 12) == 0)
+            maxPlies = atoi(argv[i] + 12);
+        else if (strncmp(argv[i], "--seed=", 7) == 0)
+            seed = static_cast<unsigned>(atoi(argv[i] + 7));
+        else if (strncmp(argv[i], "--output=", 9) == 0)
+            output = argv[i] + 9;
+        else if (!parseSettings(argv[i], "--a-", a) && !parseSettings(argv[i], "--b-", b)) {
+            fprintf(
+                stderr,
+                "usage: %s [--games=N] [--threads=N] [--opening-plies=N] [--max-plies=N] [--seed=N] [--output=path]\n"
+                "       [--a-depth=N] [--a-time=MS] [--a-hash=MB] [--a-tablebase=dir] and the same with --b-\n",
+                argv[0]
+            );
+            return 2;
+        }
+    }
+
+    if (games <= 0 || threads <= 0 || openingPlies < 0 || maxPlies <= 0 || maxPlies > 0xffff) {
+        fprintf(stderr, "games and threads have to be positive, opening plies not negative and games 1 to 65535 plies long\n");
+        return 2;
+    }
+
+    if ((a.limits.depth <= 0 && a.limits.milliseconds <= 0) || (b.limits.depth <= 0 && b.limits.milliseconds <= 0) || a.tableMegabytes <= 0 || b.tableMegabytes <= 0) {
+        fprintf(stderr, "each engine needs a depth or a time limit and a table of at least 1 MB\n");
+        return 2;
+    }
+
+    FILE* records = fopen(output, "wb");
+    if (records == nullptr) {
+        fprintf(stderr, "unable to write %s\n", output);
+        return 1;
+    }
+    fwrite(MAGIC, sizeof MAGIC, 1, records);
+    fwrite(&VERSION, sizeof VERSION, 1, records);
+
+    // probing is safe from every worker at once, so each directory is opened once and its mapped windows shared
+    Tablebase* aTablebase = a.tablebase != nullptr ? new Tablebase(a.tablebase) : nullptr;
+    Tablebase* bTablebase = b.tablebase == nullptr ? nullptr
+        : a.tablebase != nullptr && strcmp(a.tablebase, b.tablebase) == 0 ? aTablebase : new Tablebase(b.tablebase);
+
+    WorkStealingPool pool(threads);
+    std::vector<Players> players(pool.size());
+    for (Players& worker : players) {
+        worker.a = new Search(a.tableMegabytes);
+        worker.b = new Search(b.tableMegabytes);
+        worker.a->useTablebase(aTablebase);
+        worker.b->useTablebase(bTablebase);
+    }
+
+    std::mutex recordsMutex;
+    std::atomic<uint64_t> aWins(0), draws(0), bWins(0), plies(0);
+    std::atomic<int> finished(0);
+
+    // games go in pairs from the same random opening with the colors swapped, which cancels out most of the opening's bias
+    for (int game = 0; game < games; game++) {
+        pool.submit([&, game](int worker) {
+            std::mt19937 random(seed * 7919u + static_cast<unsigned>(game / 2));
+            Board board = Board::initial();
+            std::vector<uint8_t> moves;
+
+            for (int ply = 0; ply < openingPlies; ply++) {
+                MoveList list;
+                board.moves(list);
+                if (list.count == 0) break;
+
+                const int index = static_cast<int>(random() % static_cast<unsigned>(list.count));
+                moves.push_back(static_cast<uint8_t>(index));
+                board = board.played(list.moves[index]);
+            }
+
+            const bool aBlack = game % 2 == 0;
+            Players& engines = players[worker];
+            const Result result = aBlack
+                ? playGame(board, engines.a, a, engines.b, b, maxPlies, moves)
+                : playGame(board, engines.b, b, engines.a, a, maxPlies, moves);
+
+            if (result == DRAWN) draws++;
+            else if ((result == BLACK_WON) == aBlack) aWins++;
+            else bWins++;
+            plies += moves.size();
+
+            const uint16_t length = static_cast<uint16_t>(moves.size());
+            const uint8_t header[4] = {static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(result), aBlack ? FLAG_A_BLACK : uint8_t(0)};
+            {
+                std::lock_guard lock(recordsMutex);
+                fwrite(header, sizeof header, 1, records);
+                fwrite(moves.data(), 1, moves.size(), records);
+            }
+            finished++;
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto report = [&](bool last) {
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const int done = finished.load();
+        double difference = 0.0, margin = 0.0;
+        if (done > 0)
+            elo(aWins.load(), draws.load(), bWins.load(), difference, margin);
+
+        printf(
+            "\r%d/%d games  %.1f games/s  %.0f plies/s  A %llu  draws %llu  B %llu  Elo A-B %+.1f +/- %.1f%s",
+            done,
+            games,
+            static_cast<double>(done) / seconds,
+            static_cast<double>(plies.load()) / seconds,
+            static_cast<unsigned long long>(aWins.load()),
+            static_cast<unsigned long long>(draws.load()),
+            static_cast<unsigned long long>(bWins.load()),
+            difference,
+            margin,
+            last ? "\n" : ""
+        );
+        fflush(stdout);
+    };
+
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        if (finished.load() == games) break;
+        report(false);
+    }
+    pool.wait();
+    report(true);
+
+    fclose(records);
+    for (Players& worker : players) {
+        delete worker.a;
+        delete worker.b;
+    }
+    if (bTablebase != aTablebase)
+        delete bTablebase;
+    delete aTablebase;
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Jealno - an OpenGL 3D game.
+ * Copyright (C) 2024 Vadim Nikolaev (https://github.com/vadniks).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "engine/Tablebase.hpp"
+#include "engine/TablebaseGenerator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+int main(int argc, char** argv) {
+    int pieces = 4, threads = static_cast<int>(std::thread::hardware_concurrency());
+    const char* directory = "tablebase";
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--pieces=", 9) == 0)
+            pieces = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+            threads = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--output=", 9) == 0)
+            directory = argv[i] + 9;
+        else {
+            fprintf(stderr, "usage: %s [--pieces=N] [--threads=N] [--output=directory]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const std::vector<Material> materials = Material::upTo(pieces);
+    mkdir(directory, 0755);
+    TablebaseGenerator generator(threads);
+    uint64_t total = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const Material& material : materials) {
+        const auto tableStart = std::chrono::steady_clock::now();
+        const TablebaseGenerator::Result result = generator.solve(material);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tableStart).count();
+
+        if (!generator.write(material, directory)) {
+            fprintf(stderr, "unable to write %s/%s\n", directory, material.fileName().c_str());
+            return 1;
+        }
+
+        total += result.wins + result.losses + result.draws;
+        printf(
+            "%-12s %12llu positions  %10llu wins  %10llu losses  %10llu draws  %3d rounds  %7.2f s\n",
+            material.fileName().c_str(),
+            static_cast<unsigned long long>(result.wins + result.losses + result.draws),
+            static_cast<unsigned long long>(result.wins),
+            static_cast<unsigned long long>(result.losses),
+            static_cast<unsigned long long>(result.draws),
+            result.rounds,
+            seconds
+        );
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%llu positions in %.2f s\n", static_cast<unsigned long long>(total), seconds);
+
+    // the tables are read back the way the game reads them, probing the first and last position of each
+    Tablebase tablebase(directory);
+    if (tablebase.pieces() != pieces) {
+        fprintf(stderr, "tables read back cover %d pieces, expected %d\n", tablebase.pieces(), pieces);
+        return 1;
+    }
+
+    for (const Material& material : Material::upTo(tablebase.pieces())) {
+        for (const uint64_t index : {static_cast<uint64_t>(0), material.size() - 1}) {
+            Outcome outcome;
+            int distance;
+            if (!tablebase.probe(material.board(index), outcome, distance)) {
+                fprintf(stderr, "unable to probe position %llu of %s\n", static_cast<unsigned long long>(index), material.fileName().c_str());
+                return 1;
+            }
+        }
+    }
+
+    printf("%zu tables read back\n", materials.size());
+    return 0;
+}